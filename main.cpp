@@ -1,12 +1,212 @@
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include "src/Graph.h"
 #include "src/Auxiliar.h"
+#include "src/Management.h"
 #include "src/Menu.h"
+#include "src/DatasetLoader.h"
+#include "src/Server.h"
+#include "src/Trace.h"
+#include "src/Memory.h"
+#include "src/ResultCache.h"
+#include "src/ThreadPool.h"
 
-int main() {
-    Graph *g = new Graph();
-    Auxiliar::readDataset(g);
-    Menu menu = Menu(g);
-    menu.run();
-    return 0;
+/**
+ * Usage: Project2 [--dataset <0-17> | --tsplib <file.tsp>] [--algorithm <1-12> [--start <node>]] [--trace <file.json>]
+ *                 [--mem-limit <MB>] [--reorder <hilbert|morton|none>] [--tiled] [--tour-out <file.tour>]
+ *                 [--eval-tour <file.tour>] [--write-tsplib <file.tsp>] [--cache <dir>] [--threads <n>] [--pin]
+ *                 [--checkpoint <file> [--checkpoint-every <s>]]
+ *        Project2 --serve [--socket <path>] [--workers <n>] [--mem-limit <MB>] [--reorder <hilbert|morton|none>] [--tiled]
+ *                 [--cache <dir>] [--threads <n>] [--pin]
+ * Without --algorithm the interactive menu is started right away while the dataset loads in the background, otherwise
+ * the algorithm runs once in batch mode as soon as the dataset is loaded.
+ * --tour-out writes the tour of every algorithm run in the TSPLIB format, --eval-tour prints the cost of a TSPLIB
+ * tour of the loaded dataset and exits, --write-tsplib saves the loaded dataset as a TSPLIB instance and exits.
+ * --cache keeps the results in a directory, so a run repeated on the same data is answered from it, and the best tour
+ * found so far is the starting point of the local searches (see ResultCache).
+ * --threads sets how many threads the parallel parts of the loads and solvers share, one per hardware thread by
+ * default, and --pin pins them to cores (see ThreadPool).
+ * Under --serve, --workers of those threads solve requests, half of them by default, and the others are left to the
+ * parallel parts of the solves.
+ * --checkpoint saves the frontier of the exact searches (algorithms 1 and 4) every --checkpoint-every seconds, 60 by
+ * default, to the file given followed by a hash of the search; a later run on the same dataset resumes from it. It can
+ * not be used with --serve, whose exact searches stop at the deadline of their request.
+ * --serve starts the solver server on a Unix domain socket, or on stdin and stdout without --socket (see Server).
+ */
+
+namespace {
+
+/**
+ * @brief Reads a whole number given on the command line
+ * @param option name of the option, for the message
+ * @param value text of the argument
+ * @param min smallest value accepted
+ * @param max largest value accepted
+ * @return the number
+ * @throws std::invalid_argument if it is not a number
+ * @throws std::out_of_range if it is outside those bounds
+ */
+long long parseNumber(const std::string &option, const std::string &value, long long min, long long max) {
+    std::string bounds = " must be a whole number between " + std::to_string(min) + " and " + std::to_string(max);
+    size_t used = 0;
+    long long number;
+    try {
+        number = std::stoll(value, &used);
+    } catch (const std::out_of_range &) {
+        throw std::out_of_range(option + bounds);
+    } catch (const std::invalid_argument &) {
+        throw std::invalid_argument(option + bounds);
+    }
+    if (used != value.size())
+        throw std::invalid_argument(option + bounds);
+    if (number < min || number > max)
+        throw std::out_of_range(option + bounds);
+    return number;
+}
+
+void printUsage(const char *program) {
+    std::cerr << "Usage: " << program
+              << " [--dataset <0-17> | --tsplib <file.tsp>] [--algorithm <1-12> [--start <node>]]"
+              << " [--trace <file.json>] [--mem-limit <MB>] [--reorder <hilbert|morton|none>] [--tiled]"
+              << " [--tour-out <file.tour>] [--eval-tour <file.tour>] [--write-tsplib <file.tsp>]"
+              << " [--cache <dir>] [--threads <n>] [--pin] [--checkpoint <file> [--checkpoint-every <s>]]\n"
+              << "       " << program << " --serve [--socket <path>] [--workers <n>] [--cache <dir>]"
+              << " [--threads <n>] [--pin]\n";
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    int dataset = 0;
+    int algorithm = 0;
+    int start = 0;
+    std::string traceFile;
+    std::string tsplibFile;
+    std::string tourOutFile;
+    std::string evalTourFile;
+    std::string writeTsplibFile;
+    bool serve = false;
+    ServerOptions serverOptions;
+    LoadOptions loadOptions;
+    unsigned threads = 0;
+    bool pin = false;
+    std::string checkpointFile;
+    long checkpointSeconds = 60;
+
+    // a value that is not a number or out of range, or an unknown curve, prints why and the usage
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--dataset" && hasValue)
+                dataset = parseNumber(arg, argv[++i], 0, Auxiliar::NUM_DATASETS - 1);
+            else if (arg == "--algorithm" && hasValue)
+                algorithm = parseNumber(arg, argv[++i], 1, 12);
+            else if (arg == "--start" && hasValue)
+                start = parseNumber(arg, argv[++i], std::numeric_limits<int>::min(),
+                                    std::numeric_limits<int>::max());
+            else if (arg == "--trace" && hasValue)
+                traceFile = argv[++i];
+            else if (arg == "--mem-limit" && hasValue)
+                Memory::setLimit(parseNumber(arg, argv[++i], 0, std::numeric_limits<size_t>::max() >> 20) << 20);
+            else if (arg == "--reorder" && hasValue)
+                loadOptions.reorder = SpaceFillingCurve::parse(argv[++i]);
+            else if (arg == "--tiled")
+                loadOptions.tiled = true;
+            else if (arg == "--tsplib" && hasValue)
+                tsplibFile = argv[++i];
+            else if (arg == "--tour-out" && hasValue)
+                tourOutFile = argv[++i];
+            else if (arg == "--eval-tour" && hasValue)
+                evalTourFile = argv[++i];
+            else if (arg == "--write-tsplib" && hasValue)
+                writeTsplibFile = argv[++i];
+            else if (arg == "--cache" && hasValue)
+                ResultCache::setDirectory(argv[++i]);
+            else if (arg == "--threads" && hasValue)
+                threads = parseNumber(arg, argv[++i], 0, ThreadPool::MAX_THREADS);
+            else if (arg == "--pin")
+                pin = true;
+            else if (arg == "--checkpoint" && hasValue)
+                checkpointFile = argv[++i];
+            else if (arg == "--checkpoint-every" && hasValue)
+                checkpointSeconds = parseNumber(arg, argv[++i], 1, std::numeric_limits<long>::max() / 1000);
+            else if (arg == "--serve")
+                serve = true;
+            else if (arg == "--socket" && hasValue)
+                serverOptions.socketPath = argv[++i];
+            else if (arg == "--workers" && hasValue)
+                serverOptions.workers = parseNumber(arg, argv[++i], 0, ThreadPool::MAX_THREADS);
+            else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::logic_error &e) {
+        std::cerr << e.what() << "\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (serve && !checkpointFile.empty()) {
+        std::cerr << "--checkpoint can not be used with --serve\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+    Auxiliar::setLoadOptions(loadOptions);
+    if (threads > 0 || pin)
+        ThreadPool::configureGlobal(threads, pin);
+    if (!checkpointFile.empty())
+        Management::setCheckpoint(checkpointFile, checkpointSeconds * 1000);
+
+    if (!traceFile.empty()) {
+        Trace::start(traceFile);
+        Trace::setThreadName("main");
+    }
+
+    if (serve) {
+        Server server(serverOptions);
+        int status = server.run();
+        if (status != 0)
+            std::cerr << "Could not listen on " << serverOptions.socketPath << "\n";
+        if (!traceFile.empty())
+            Trace::stop();
+        return status;
+    }
+
+    auto loader = std::make_unique<DatasetLoader>(tsplibFile.empty() ? DatasetLoader::dataset(dataset)
+                                                                     : DatasetLoader::tsplib(tsplibFile));
+    if (!tsplibFile.empty())
+        dataset = -1;
+
+    if (!evalTourFile.empty() || !writeTsplibFile.empty()) {
+        try {
+            std::unique_ptr<Graph> g(loader->take());
+            if (!evalTourFile.empty()) {
+                std::vector<int> tour = Auxiliar::readTour(g.get(), evalTourFile);
+                std::cout << "Tour cost: " << Management::tourCost(g.get(), tour) << "\n";
+            } else {
+                std::string name = dataset < 0 ? loader->getName() : "dataset" + std::to_string(dataset);
+                Auxiliar::writeTsplib(g.get(), writeTsplibFile, name);
+            }
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    Menu menu(std::move(loader), dataset, tsplibFile);
+    menu.setTourOutput(tourOutFile);
+    bool ok = true;
+    if (algorithm == 0)
+        menu.run();
+    else
+        ok = menu.runBatch(algorithm, start);
+
+    if (!traceFile.empty() && !Trace::stop())
+        std::cerr << "Could not write the trace to " << traceFile << "\n";
+    return ok ? 0 : 1;
 }
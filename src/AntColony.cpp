@@ -0,0 +1,219 @@
+#include "AntColony.h"
+#include "Graph.h"
+#include "Management.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+/**
+ * @brief Builds the candidate lists and the pheromone matrix
+ * @param graph graph with a complete distance matrix
+ * @param options parameters of the search
+ * @details The pheromone starts at the maximum bound given by a greedy edge tour, as in the MAX-MIN ant system.
+ * Time Complexity O(v²) -> v: number of vertices
+ */
+AntColony::AntColony(Graph *graph, const AntColonyOptions &options)
+        : graph(graph), options(options), cand(graph, std::min(options.candidates, 64), options.source),
+          n(cand.size()), bestCost(INF) {
+    TRACE_SPAN("AntColony setup", "solve");
+    if (this->options.ants <= 0)
+        this->options.ants = std::min(n, 64);
+    if (n < 2)
+        return;
+
+    int k = cand.getK();
+    heuristic.assign((size_t) n * k, 0);
+    for (int v = 0; v < n; v++) {
+        auto list = cand.of(v);
+        for (size_t r = 0; r < list.size(); r++)
+            heuristic[(size_t) v * k + r] = std::pow(1.0 / std::max(cand.dist(v, list[r]), 1e-9), options.beta);
+    }
+
+    double reference = Management::tspGreedyEdge(graph);
+    tauMax = (float) (1.0 / (options.rho * std::max(reference, 1e-9)));
+    tauMin = tauMax / (2.0f * n);
+    pheromone.assign((size_t) n * n, tauMax);
+}
+
+/**
+ * @brief Runs iterations until the time limit: the ants build (and polish) their tours in parallel, then the
+ * pheromone evaporates and the best tour of the iteration (every fifth iteration the best so far) deposits on its edges
+ * @return Cost of the best tour found
+ * @details Time Complexity O(v² + a v k) per iteration -> v: number of vertices, a: number of ants,
+ * k: candidates per vertex
+ */
+double AntColony::run() {
+    TRACE_SPAN("AntColony", "solve");
+    if (n < 2) {
+        best.assign(n, 0);
+        return bestCost = 0;
+    }
+
+    int ants = options.ants;
+    std::vector<std::vector<int>> tours(ants, std::vector<int>(n));
+    std::vector<double> costs(ants);
+    Memory::noteScratch(pheromone.capacity() * sizeof(float) + heuristic.capacity() * sizeof(double) +
+                        (size_t) ants * n * (sizeof(int) + 1));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeLimitMs);
+    do {
+        ThreadPool::global().parallelFor(0, ants, 1, [&](int lo, int hi) {
+            std::vector<char> visited(n);
+            for (int a = lo; a < hi; a++) {
+                costs[a] = buildTour(a, tours[a], visited);
+                if (options.localSearch) {
+                    Management::improveTwoOptCandidates(cand, tours[a]);
+                    costs[a] = cost(tours[a]);
+                }
+            }
+        });
+
+        int iterationBest = std::min_element(costs.begin(), costs.end()) - costs.begin();
+        if (costs[iterationBest] < bestCost) {
+            bestCost = costs[iterationBest];
+            best = tours[iterationBest];
+            // the bounds follow the best tour so far
+            tauMax = (float) (1.0 / (options.rho * bestCost));
+            tauMin = tauMax / (2.0f * n);
+        }
+
+        evaporate();
+        if (iterations % 5 == 4)
+            deposit(best, bestCost);
+        else
+            deposit(tours[iterationBest], costs[iterationBest]);
+        iterations++;
+    } while (std::chrono::steady_clock::now() < deadline && !(options.stop != nullptr && *options.stop));
+
+    return bestCost;
+}
+
+/**
+ * @brief Builds the tour of one ant from a random start. The next vertex is drawn among the unvisited candidates of
+ * the current one; when all of them were visited, the unvisited vertex with the most attractive edge is taken.
+ * @param ant index of the ant in the iteration, which seeds its random generator
+ * @param tour receives the tour
+ * @param visited scratch flags, one per vertex
+ * @return Cost of the tour
+ * @details Time Complexity O(v k) plus O(v) per fallback step -> v: number of vertices, k: candidates per vertex
+ */
+double AntColony::buildTour(int ant, std::vector<int> &tour, std::vector<char> &visited) {
+    std::mt19937 rng(options.seed + (uint32_t) (iterations * options.ants + ant));
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::fill(visited.begin(), visited.end(), 0);
+
+    int k = cand.getK();
+    int cur = rng() % n;
+    tour[0] = cur;
+    visited[cur] = 1;
+    double cost = 0;
+    double weights[64];
+
+    for (int step = 1; step < n; step++) {
+        const float *row = pheromone.data() + (size_t) cur * n;
+        auto list = cand.of(cur);
+        double total = 0;
+        int count = list.size();
+        for (int r = 0; r < count; r++) {
+            int c = list[r];
+            weights[r] = visited[c] ? 0 : row[c] * heuristic[(size_t) cur * k + r];
+            total += weights[r];
+        }
+
+        int next = -1;
+        if (total > 0) {
+            double pick = unit(rng) * total;
+            for (int r = 0; r < count && next == -1; r++) {
+                pick -= weights[r];
+                if (pick <= 0 && weights[r] > 0)
+                    next = list[r];
+            }
+            // rounding left the pick past the last weight
+            for (int r = count - 1; r >= 0 && next == -1; r--) {
+                if (weights[r] > 0)
+                    next = list[r];
+            }
+        } else {
+            double bestWeight = -1;
+            for (int w = 0; w < n; w++) {
+                if (visited[w])
+                    continue;
+                double weight = row[w] * std::pow(1.0 / std::max(cand.dist(cur, w), 1e-9), options.beta);
+                if (weight > bestWeight) {
+                    bestWeight = weight;
+                    next = w;
+                }
+            }
+        }
+
+        cost += cand.dist(cur, next);
+        tour[step] = next;
+        visited[next] = 1;
+        cur = next;
+    }
+    return cost + cand.dist(cur, tour[0]);
+}
+
+/**
+ * @brief Cost of a closed tour of vertex indices
+ */
+double AntColony::cost(const std::vector<int> &tour) const {
+    double total = 0;
+    for (int i = 0; i < n; i++)
+        total += cand.dist(tour[i], tour[(i + 1) % n]);
+    return total;
+}
+
+/**
+ * @brief Evaporates the pheromone and clamps it to the MAX-MIN bounds, in parallel blocks of rows.
+ * The loop has no branches or dependencies between entries, so it compiles to packed min/max/multiply instructions.
+ * @details Time Complexity O(v² / t) -> v: number of vertices, t: number of threads
+ */
+void AntColony::evaporate() {
+    const float keep = (float) (1.0 - options.rho);
+    const float lo = tauMin, hi = tauMax;
+    ThreadPool::global().parallelFor(0, n, 64, [&](int rowLo, int rowHi) {
+        float *__restrict tau = pheromone.data() + (size_t) rowLo * n;
+        size_t count = (size_t) (rowHi - rowLo) * n;
+        for (size_t i = 0; i < count; i++)
+            tau[i] = std::min(hi, std::max(lo, tau[i] * keep));
+    });
+}
+
+/**
+ * @brief Adds 1 / cost to the pheromone of both directions of every edge of a tour, up to the maximum bound
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+void AntColony::deposit(const std::vector<int> &tour, double cost) {
+    float amount = (float) (1.0 / std::max(cost, 1e-9));
+    for (int i = 0; i < n; i++) {
+        int a = tour[i], b = tour[(i + 1) % n];
+        float value = std::min(tauMax, pheromone[(size_t) a * n + b] + amount);
+        pheromone[(size_t) a * n + b] = value;
+        pheromone[(size_t) b * n + a] = value;
+    }
+}
+
+/**
+ * @brief Best tour found by the last run
+ * @return vertex infos of the tour, starting at node 0 of the dataset, empty if run was not called
+ */
+std::vector<int> AntColony::getBestTour() const {
+    std::vector<int> tour;
+    for (int idx : best)
+        tour.push_back(cand.getInfo(idx));
+    auto first = std::find(tour.begin(), tour.end(), graph->getInternalId(0));
+    if (first != tour.end())
+        std::rotate(tour.begin(), first, tour.end());
+    return tour;
+}
+
+/**
+ * @brief Iterations run by the last run
+ */
+long AntColony::getIterations() const {
+    return iterations;
+}
@@ -0,0 +1,73 @@
+#ifndef PROJECT2_ANTCOLONY_H
+#define PROJECT2_ANTCOLONY_H
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Candidates.h"
+
+class Graph;
+
+/**
+ * @brief Parameters of the ant colony optimisation
+ */
+struct AntColonyOptions {
+    // ants per iteration, 0 for one per vertex up to 64
+    int ants = 0;
+    // candidate neighbours per vertex, at most 64
+    int candidates = 15;
+    // Edges keeps the ants on the graph's own edges as long as the current vertex has an unvisited neighbour
+    CandidateSource source = CandidateSource::Matrix;
+    // 2-opt over the candidate lists on every tour built
+    bool localSearch = true;
+    // weight of the distance against the pheromone when choosing the next vertex
+    double beta = 2.0;
+    // fraction of the pheromone that evaporates every iteration
+    double rho = 0.1;
+    long timeLimitMs = 10000;
+    // flag set by another thread to end the search before the time limit, such as a rival solver proving optimality;
+    // ignored if null
+    const std::atomic<bool> *stop = nullptr;
+    uint32_t seed = 1;
+};
+
+/**
+ * @brief MAX-MIN ant system: every iteration a batch of ants builds tours in parallel, each choosing its next vertex
+ * among the candidates of the current one with probability proportional to pheromone * (1 / distance)^beta, and the
+ * best tour reinforces its edges. Every tour can be polished by 2-opt before the pheromone update.
+ * The pheromone is one contiguous row-major v x v matrix of floats indexed like the distance matrix, evaporated and
+ * clamped to [min, max] with a branch-free pass the compiler vectorises.
+ */
+class AntColony {
+public:
+    AntColony(Graph *graph, const AntColonyOptions &options);
+
+    double run();
+    std::vector<int> getBestTour() const;
+    long getIterations() const;
+
+private:
+    double buildTour(int ant, std::vector<int> &tour, std::vector<char> &visited);
+    double cost(const std::vector<int> &tour) const;
+    void evaporate();
+    void deposit(const std::vector<int> &tour, double cost);
+
+    Graph *graph;
+    AntColonyOptions options;
+    CandidateLists cand;
+    int n;
+
+    std::vector<float> pheromone;
+    // (1 / distance)^beta of every candidate, in the layout of the candidate lists
+    std::vector<double> heuristic;
+    float tauMin = 0;
+    float tauMax = 1;
+
+    long iterations = 0;
+    std::vector<int> best;
+    double bestCost;
+};
+
+#endif //PROJECT2_ANTCOLONY_H
@@ -1,26 +1,266 @@
 #include "Auxiliar.h"
 #include "Management.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "ThreadPool.h"
 
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <new>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <filesystem>
+#include <functional>
+
+LoadOptions Auxiliar::options;
+
+namespace {
+
+/**
+ * @brief Size of a file in bytes, 0 if it can not be read
+ */
+size_t fileSize(const std::string &filename) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(filename, ec);
+    return ec ? 0 : size;
+}
+
+void startStage(LoadProgress *progress, LoadStage stage, size_t total) {
+    if (progress != nullptr)
+        progress->start(stage, total);
+}
+
+/**
+ * @brief Reports work done, and throws LoadCancelled if the load was cancelled
+ */
+void advance(LoadProgress *progress, size_t amount) {
+    if (progress != nullptr) {
+        progress->advance(amount);
+        progress->check();
+    }
+}
+
+/**
+ * @brief Splits a file in whitespace separated tokens, reading it in blocks so big files are never held in memory
+ */
+class TokenReader {
+public:
+    explicit TokenReader(const std::string &filename) : file(filename, std::ios::binary), buf(1 << 20) {
+        if (!file)
+            throw std::runtime_error("Could not open " + filename);
+    }
+
+    /**
+     * @brief Next token, empty at the end of the file. It stays valid until the next call.
+     */
+    std::string_view token() {
+        while (true) {
+            while (pos < end && isSpace(buf[pos]))
+                pos++;
+            if (pos < end)
+                break;
+            if (!fill())
+                return {};
+        }
+        size_t i = pos;
+        while (true) {
+            while (i < end && !isSpace(buf[i]))
+                i++;
+            if (i < end)
+                break;
+            // the token runs to the end of the block, bring the rest of it in
+            size_t read = i - pos;
+            if (!fill())
+                break;
+            i = pos + read;
+        }
+        std::string_view t(buf.data() + pos, i - pos);
+        pos = i;
+        return t;
+    }
+
+    /**
+     * @brief Rest of the current line, without the line break
+     */
+    std::string line() {
+        std::string res;
+        while (true) {
+            while (pos < end && buf[pos] != '\n')
+                res += buf[pos++];
+            if (pos < end || !fill())
+                break;
+        }
+        if (pos < end)
+            pos++;
+        if (!res.empty() && res.back() == '\r')
+            res.pop_back();
+        return res;
+    }
+
+    double number() {
+        std::string_view t = token();
+        double value;
+        auto [ptr, ec] = std::from_chars(t.data(), t.data() + t.size(), value);
+        if (ec != std::errc() || ptr != t.data() + t.size())
+            throw std::runtime_error("Expected a number but found \"" + std::string(t) + "\"");
+        return value;
+    }
+
+    int integer() {
+        std::string_view t = token();
+        int value;
+        auto [ptr, ec] = std::from_chars(t.data(), t.data() + t.size(), value);
+        if (ec != std::errc() || ptr != t.data() + t.size())
+            throw std::runtime_error("Expected an integer but found \"" + std::string(t) + "\"");
+        return value;
+    }
+
+private:
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    /**
+     * @brief Moves the unread bytes to the front of the buffer and reads the next block after them
+     * @return false at the end of the file
+     */
+    bool fill() {
+        std::memmove(buf.data(), buf.data() + pos, end - pos);
+        end -= pos;
+        pos = 0;
+        if (end == buf.size())
+            buf.resize(2 * buf.size());
+        file.read(buf.data() + end, buf.size() - end);
+        size_t read = file.gcount();
+        end += read;
+        return read > 0;
+    }
+
+    std::ifstream file;
+    std::vector<char> buf;
+    size_t pos = 0;
+    size_t end = 0;
+};
+
+/**
+ * @brief Removes the separating colon and the surrounding spaces from a header value
+ */
+std::string trimValue(std::string value) {
+    size_t first = value.find_first_not_of(" \t:");
+    if (first == std::string::npos)
+        return "";
+    size_t last = value.find_last_not_of(" \t");
+    return value.substr(first, last - first + 1);
+}
+
+}
+
+/**
+ * @brief Moves to a new stage
+ * @param newStage stage that starts
+ * @param newTotal amount of work of the stage, in whatever unit its advance calls use
+ */
+void LoadProgress::start(LoadStage newStage, size_t newTotal) {
+    done = 0;
+    total = newTotal;
+    stage = newStage;
+}
+
+void LoadProgress::advance(size_t amount) {
+    done.fetch_add(amount, std::memory_order_relaxed);
+}
+
+/**
+ * @throws LoadCancelled if cancel was called
+ */
+void LoadProgress::check() const {
+    if (cancelled.load(std::memory_order_relaxed))
+        throw LoadCancelled();
+}
+
+void LoadProgress::cancel() {
+    cancelled = true;
+}
+
+bool LoadProgress::isCancelled() const {
+    return cancelled;
+}
+
+LoadStage LoadProgress::getStage() const {
+    return stage;
+}
+
+/**
+ * @brief Sets what runs once the vertices are created, before the load starts
+ * @param callback function given the graph, whose vertex set and coordinates are final from then on
+ */
+void LoadProgress::setOnVertices(std::function<void(Graph *)> callback) {
+    onVertices = std::move(callback);
+}
+
+/**
+ * @brief Called by the readers when every vertex has its final info and coordinates. The callback runs on the
+ * loading thread, so it should hand long work to another thread.
+ */
+void LoadProgress::verticesReady(Graph *g) {
+    if (onVertices)
+        onVertices(g);
+}
+
+/**
+ * @brief Current stage and how far into it the load is, for example "filling the matrix 40%"
+ */
+std::string LoadProgress::describe() const {
+    static const char *names[] = {"parsing", "building the vertices", "filling the matrix", "done"};
+    LoadStage s = stage;
+    std::string res = names[(int) s];
+    size_t t = total, d = std::min<size_t>(done, t);
+    if (s != LoadStage::Done && t > 0)
+        res += " " + std::to_string(d * 100 / t) + "%";
+    return res;
+}
+
+/**
+ * @brief Sets the options applied by readDataset
+ * @param newOptions load options
+ */
+void Auxiliar::setLoadOptions(const LoadOptions &newOptions) {
+    options = newOptions;
+}
+
+LoadOptions Auxiliar::getLoadOptions() {
+    return options;
+}
 
 /**
  * @brief Initialize distance matrix with 0 for a graph
  * @param n number of vertices
  * @return distance matrix
+ * @throws std::runtime_error if the matrix does not fit in the memory limit
  * @details Time Complexity O(v²) -> v: number of vertices
  */
 double **Auxiliar::initMatrix(int n) {
+    TRACE_SPAN("allocate matrix", "load");
+    Memory::checkFits("distance matrix of " + std::to_string(n) + " vertices",
+                      (size_t) n * (n * sizeof(double) + sizeof(double *)));
+    STATS_TIMER(Phase::MatrixInit);
     auto matrix = new double*[n];
+    // every thread allocates and zeroes its own block of rows, so the pages are first touched, and placed, on the NUMA
+    // node of the core that scans those rows later in parallelForBlocks loops
+    ThreadPool::global().parallelForBlocks(0, n, [&](int lo, int hi) {
+        for (int i = lo; i < hi; ++i)
+            matrix[i] = new (std::nothrow) double[n]();
+    });
     for (int i = 0; i < n; ++i) {
-        matrix[i] = new double[n];
-    }
-
-    // Initialize all elements to 0
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            matrix[i][j] = 0.0;
+        if (matrix[i] == nullptr) {
+            for (int j = 0; j < n; ++j)
+                delete[] matrix[j];
+            delete[] matrix;
+            throw std::bad_alloc();
         }
     }
 
@@ -31,9 +271,37 @@ double **Auxiliar::initMatrix(int n) {
  * @brief Reads the selected DataSet
  * @param g The main graph
  * @param dataset dataset to load
+ * @param progress where the progress is reported and cancellation is checked, nullptr for neither
+ * @throws LoadCancelled if the load is cancelled through progress
+ * @details The load options (curve renumbering, tiled matrix) set with setLoadOptions are applied.
  */
-void Auxiliar::readDataset(Graph *g, int dataset) {
-    std::string files[18];
+void Auxiliar::readDataset(Graph *g, int dataset, LoadProgress *progress) {
+    TRACE_SPAN("readDataset", "load");
+    std::string filename = datasetPath(dataset);
+
+    if (dataset <= 2){
+        Auxiliar::readSmall(g, filename, progress);
+    }
+    else if (dataset <= 14){
+        Auxiliar::readMedium(g, filename, progress);
+    }
+    else if (dataset <= 17){
+        Auxiliar::readLarge(g, filename, progress);
+    }
+
+    if (options.tiled) {
+        TRACE_SPAN("tile matrix", "load");
+        g->useTiledLayout();
+    }
+    startStage(progress, LoadStage::Done, 0);
+}
+
+/**
+ * @brief Path of one of the datasets: a csv file, or the directory of nodes.csv and edges.csv for the real world ones
+ * @param dataset dataset index, 0 to 17
+ */
+std::string Auxiliar::datasetPath(int dataset) {
+    std::string files[NUM_DATASETS];
     files[0] = "../data/Toy_Graphs/shipping.csv";
     files[1] = "../data/Toy_Graphs/stadiums.csv";
     files[2] = "../data/Toy_Graphs/tourism.csv";
@@ -52,34 +320,41 @@ void Auxiliar::readDataset(Graph *g, int dataset) {
     files[15] = "../data/Real_World_Graphs/graph1/";
     files[16] = "../data/Real_World_Graphs/graph2/";
     files[17] = "../data/Real_World_Graphs/graph3/";
-    std::string filename = files[dataset];
-
-    if (dataset <= 2){
-        Auxiliar::readSmall(g, filename);
-    }
-    else if (dataset <= 14){
-        Auxiliar::readMedium(g, filename);
-    }
-    else if (dataset <= 17){
-        Auxiliar::readLarge(g, filename);
-    }
+    return files[dataset];
+}
 
+/**
+ * @brief Files read to load one of the datasets
+ * @param dataset dataset index, 0 to 17
+ */
+std::vector<std::string> Auxiliar::datasetFiles(int dataset) {
+    std::string path = datasetPath(dataset);
+    if (dataset >= 15)
+        return {path + "nodes.csv", path + "edges.csv"};
+    return {path};
 }
 
 /**
  * @brief Reads the small dataset
  * @param g The main graph
  * @param filename file to read
+ * @param progress where the progress is reported and cancellation is checked, nullptr for neither
  * @details Time Complexity O(v²) -> v: number of vertices
  */
-void Auxiliar::readSmall(Graph *g, std::string filename) {
+void Auxiliar::readSmall(Graph *g, std::string filename, LoadProgress *progress) {
+    STATS_TIMER(Phase::Load);
+    TRACE_SPAN("readSmall", "load");
 
+    // the file is read twice, once for the vertices and once for the edges
+    startStage(progress, LoadStage::Parse, 2 * fileSize(filename));
     std::ifstream fileV(filename);
     std::string line, orig, dest, distance;
     getline(fileV, line);
     int nrVertex = 0;
 
     while (std::getline(fileV, line)){
+        STATS_INC(Counter::RowsParsed);
+        advance(progress, line.size() + 1);
         std::istringstream ss(line);
         getline(ss, orig, ',');
         getline(ss, dest, ',');
@@ -88,12 +363,14 @@ void Auxiliar::readSmall(Graph *g, std::string filename) {
         nrVertex += g->addVertex(std::stoi(dest));
     }
 
-    g->setMatrix(Auxiliar::initMatrix(nrVertex));
+    g->setMatrix(Auxiliar::initMatrix(nrVertex), nrVertex);
 
     std::ifstream fileE(filename);
     getline(fileE, line);
 
     while (std::getline(fileE, line)){
+        STATS_INC(Counter::RowsParsed);
+        advance(progress, line.size() + 1);
         std::istringstream ss(line);
         getline(ss, orig, ',');
         getline(ss, dest, ',');
@@ -103,12 +380,7 @@ void Auxiliar::readSmall(Graph *g, std::string filename) {
     }
 
     if (filename == "../data/Toy_Graphs/shipping.csv"){
-        for (int i = 0; i < nrVertex; i++) {
-            for (int j = 0; j < nrVertex; j++) {
-                if ((j != i) && (g->getDist(i, j) == 0))
-                    g->addToDistMatrix(i, j, Management::getHaversineDist(g->findVertex(i), g->findVertex(j)));
-            }
-        }
+        Auxiliar::completeMatrix(g, nrVertex, progress);
     }
 
 }
@@ -117,10 +389,14 @@ void Auxiliar::readSmall(Graph *g, std::string filename) {
  * @brief Reads the medium graph
  * @param g The main graph
  * @param filename file to read
+ * @param progress where the progress is reported and cancellation is checked, nullptr for neither
  * @details Time Complexity O(v) -> v: number of vertices
  */
-void Auxiliar::readMedium(Graph *g, std::string filename) {
+void Auxiliar::readMedium(Graph *g, std::string filename, LoadProgress *progress) {
+    STATS_TIMER(Phase::Load);
+    TRACE_SPAN("readMedium", "load");
 
+    startStage(progress, LoadStage::Parse, fileSize(filename));
     std::ifstream file(filename);
     std::string line, orig, dest, distance;
     getline(file, line);
@@ -128,9 +404,11 @@ void Auxiliar::readMedium(Graph *g, std::string filename) {
     std::string auxFilename = filename.substr(43, filename.length());
     int nrVertex = std::stoi(auxFilename.substr(0, auxFilename.length() - 4));
 
-     g->setMatrix(Auxiliar::initMatrix(nrVertex));
+     g->setMatrix(Auxiliar::initMatrix(nrVertex), nrVertex);
 
     while (std::getline(file, line)){
+        STATS_INC(Counter::RowsParsed);
+        advance(progress, line.size() + 1);
         std::istringstream ss(line);
         getline(ss, orig, ',');
         getline(ss, dest, ',');
@@ -147,45 +425,446 @@ void Auxiliar::readMedium(Graph *g, std::string filename) {
  * @brief Reads the large dataset
  * @param g The main graph
  * @param filename file to read
+ * @param progress where the progress is reported and cancellation is checked, nullptr for neither
  * @details Time Complexity O(v²) -> v: number of vertices
  */
-void Auxiliar::readLarge(Graph *g, std::string filename) {
+void Auxiliar::readLarge(Graph *g, std::string filename, LoadProgress *progress) {
+    STATS_TIMER(Phase::Load);
+    TRACE_SPAN("readLarge", "load");
 
-    std::ifstream vertexFile(filename + "nodes.csv");
     std::string line;
-    std::string id, longitude, latitude;
-    int nrVertex = 0;
-    getline(vertexFile, line);
+    std::vector<std::tuple<int, double, double>> nodes;
+    // parsing covers both files, the vertices are created in between
+    size_t nodesBytes = fileSize(filename + "nodes.csv");
+    size_t parseBytes = nodesBytes + fileSize(filename + "edges.csv");
+    startStage(progress, LoadStage::Parse, parseBytes);
+    {
+        TRACE_SPAN("parse nodes.csv", "load");
+        std::ifstream vertexFile(filename + "nodes.csv");
+        std::string id, longitude, latitude;
+        getline(vertexFile, line);
 
-    while (std::getline(vertexFile, line)){
-        std::istringstream ss(line);
-        getline(ss, id, ',');
-        getline(ss, longitude, ',');
-        getline(ss, latitude, '\r');
-        g->addVertex(std::stoi(id), std::stod(longitude), std::stod(latitude));
-        nrVertex++;
+        while (std::getline(vertexFile, line)){
+            STATS_INC(Counter::RowsParsed);
+            advance(progress, line.size() + 1);
+            std::istringstream ss(line);
+            getline(ss, id, ',');
+            getline(ss, longitude, ',');
+            getline(ss, latitude, '\r');
+            nodes.emplace_back(std::stoi(id), std::stod(longitude), std::stod(latitude));
+        }
     }
 
-    g->setMatrix(Auxiliar::initMatrix(nrVertex));
+    int nrVertex = nodes.size();
+    std::vector<int> order(nrVertex);
+    std::iota(order.begin(), order.end(), 0);
+    if (options.reorder != Curve::None) {
+        // number the vertices along the curve, so spatially close vertices get close indices
+        TRACE_SPAN("curve reorder", "load");
+        std::vector<double> xs, ys;
+        for (auto &[id, longitude, latitude] : nodes) {
+            xs.push_back(longitude);
+            ys.push_back(latitude);
+        }
+        order = SpaceFillingCurve::order(xs, ys, options.reorder);
+    }
 
-    std::ifstream file(filename + "edges.csv");
-    std::string orig, dest, distance;
-    getline(file, line);
+    {
+        TRACE_SPAN("create vertices", "load");
+        startStage(progress, LoadStage::Vertices, nrVertex);
+        g->reserve(nrVertex);
+        std::vector<int> originalIds;
+        for (int k = 0; k < nrVertex; k++) {
+            advance(progress, 1);
+            auto &[id, longitude, latitude] = nodes[order[k]];
+            if (options.reorder == Curve::None) {
+                g->addVertex(id, longitude, latitude);
+            } else {
+                g->addVertex(k, longitude, latitude);
+                originalIds.push_back(id);
+            }
+        }
+        if (options.reorder != Curve::None)
+            g->setOriginalIds(originalIds);
+    }
+    if (progress != nullptr)
+        progress->verticesReady(g);
 
-    while (std::getline(file, line)){
-        std::istringstream ss(line);
-        getline(ss, orig, ',');
-        getline(ss, dest, ',');
-        getline(ss, distance, '\r');
-        g->addBidirectionalEdge(std::stoi(orig), std::stoi(dest), std::stod(distance));
-        g->addToDistMatrix(stoi(orig), stoi(dest), stod(distance));
+    g->setMatrix(Auxiliar::initMatrix(nrVertex), nrVertex);
+
+    {
+        TRACE_SPAN("parse edges.csv", "load");
+        startStage(progress, LoadStage::Parse, parseBytes);
+        advance(progress, nodesBytes);
+        std::ifstream file(filename + "edges.csv");
+        std::string orig, dest, distance;
+        getline(file, line);
+
+        while (std::getline(file, line)){
+            STATS_INC(Counter::RowsParsed);
+            advance(progress, line.size() + 1);
+            std::istringstream ss(line);
+            getline(ss, orig, ',');
+            getline(ss, dest, ',');
+            getline(ss, distance, '\r');
+            int o = g->getInternalId(std::stoi(orig));
+            int d = g->getInternalId(std::stoi(dest));
+            if (o < 0 || g->findVertex(o) == nullptr || d < 0 || g->findVertex(d) == nullptr)
+                throw std::runtime_error("The edge " + orig + "," + dest + " of " + filename +
+                                         "edges.csv names a node that is not in nodes.csv");
+            double w = std::stod(distance);
+            g->addBidirectionalEdge(o, d, w);
+            g->addToDistMatrix(o, d, w);
+        }
     }
 
-    for (int i = 0; i < nrVertex - 1; i++) {
-        for (int j = 0; j < i + 1; j++){
-            if ((g->getDist(i, j) == 0)) {
-                g->addToDistMatrix(i, j, Management::getHaversineDist(g->findVertex(i), g->findVertex(j)));
+    Auxiliar::completeMatrix(g, nrVertex, progress);
+}
+
+/**
+ * @brief Reads a TSPLIB instance (.tsp) into an empty graph. Vertex k of the file gets info k - 1.
+ * EUC_2D, GEO and ATT instances only keep the coordinates and compute each distance when it is asked for, so no
+ * matrix is allocated and instances with hundreds of thousands of vertices load in linear time and memory.
+ * EXPLICIT instances, in any of the full, upper and lower row formats, are read into the distance matrix.
+ * No edges are created, so the algorithms that follow edges (backtracking and the real world one) find no tour.
+ * @param g The main graph
+ * @param filename file to read
+ * @param progress where the progress is reported and cancellation is checked, nullptr for neither
+ * @return Name of the instance
+ * @throws std::runtime_error if the file can not be read or uses a type or format that is not supported
+ * @details Time Complexity O(v) for coordinates, O(v²) for explicit matrices -> v: number of vertices
+ */
+std::string Auxiliar::readTsplib(Graph *g, const std::string &filename, LoadProgress *progress) {
+    STATS_TIMER(Phase::Load);
+    TRACE_SPAN("readTsplib", "load");
+
+    TokenReader in(filename);
+    std::string name = filename, type = "TSP", weightType, weightFormat;
+    int n = -1;
+    std::vector<double> xs, ys;
+    bool hasCoordinates = false, hasWeights = false;
+
+    while (true) {
+        std::string_view t = in.token();
+        if (t.empty() || t == "EOF")
+            break;
+        if (t == "NODE_COORD_SECTION") {
+            TRACE_SPAN("parse coordinates", "load");
+            if (n < 0)
+                throw std::runtime_error("NODE_COORD_SECTION before DIMENSION in " + filename);
+            xs.assign(n, 0);
+            ys.assign(n, 0);
+            startStage(progress, LoadStage::Parse, n);
+            for (int k = 0; k < n; k++) {
+                STATS_INC(Counter::RowsParsed);
+                advance(progress, 1);
+                int id = in.integer();
+                if (id < 1 || id > n)
+                    throw std::runtime_error("Node " + std::to_string(id) + " out of range in " + filename);
+                xs[id - 1] = in.number();
+                ys[id - 1] = in.number();
             }
+            hasCoordinates = true;
+            continue;
+        }
+        if (t == "EDGE_WEIGHT_SECTION") {
+            TRACE_SPAN("parse weights", "load");
+            if (n < 0)
+                throw std::runtime_error("EDGE_WEIGHT_SECTION before DIMENSION in " + filename);
+            // row i of the format holds the columns first(i)..last(i) - 1
+            std::function<int(int)> first, last;
+            if (weightFormat == "FULL_MATRIX") {
+                first = [](int) { return 0; };
+                last = [n](int) { return n; };
+            } else if (weightFormat == "UPPER_ROW") {
+                first = [](int i) { return i + 1; };
+                last = [n](int) { return n; };
+            } else if (weightFormat == "LOWER_ROW") {
+                first = [](int) { return 0; };
+                last = [](int i) { return i; };
+            } else if (weightFormat == "UPPER_DIAG_ROW") {
+                first = [](int i) { return i; };
+                last = [n](int) { return n; };
+            } else if (weightFormat == "LOWER_DIAG_ROW") {
+                first = [](int) { return 0; };
+                last = [](int i) { return i + 1; };
+            } else {
+                throw std::runtime_error("Unsupported EDGE_WEIGHT_FORMAT " + weightFormat + " in " + filename);
+            }
+            double **matrix = Auxiliar::initMatrix(n);
+            g->setMatrix(matrix, n);
+            startStage(progress, LoadStage::Parse, n);
+            bool full = weightFormat == "FULL_MATRIX";
+            for (int i = 0; i < n; i++) {
+                STATS_INC(Counter::RowsParsed);
+                advance(progress, 1);
+                for (int j = first(i); j < last(i); j++) {
+                    if (full)
+                        matrix[i][j] = in.number();
+                    else
+                        matrix[i][j] = matrix[j][i] = in.number();
+                }
+            }
+            hasWeights = true;
+            continue;
+        }
+        if (t == "DISPLAY_DATA_SECTION") {
+            for (int k = 0; k < 3 * n; k++)
+                in.token();
+            continue;
+        }
+
+        // header line, "KEY : VALUE" or "KEY: VALUE"
+        std::string key(t), value;
+        size_t colon = key.find(':');
+        if (colon != std::string::npos) {
+            value = key.substr(colon + 1) + " ";
+            key.resize(colon);
+        }
+        value = trimValue(value + in.line());
+        if (key == "NAME")
+            name = value;
+        else if (key == "TYPE")
+            type = value;
+        else if (key == "DIMENSION")
+            n = std::stoi(value);
+        else if (key == "EDGE_WEIGHT_TYPE")
+            weightType = value;
+        else if (key == "EDGE_WEIGHT_FORMAT")
+            weightFormat = value;
+    }
+
+    if (type != "TSP")
+        throw std::runtime_error("Unsupported TYPE " + type + " in " + filename);
+    if (n < 0)
+        throw std::runtime_error("Missing DIMENSION in " + filename);
+
+    Metric metric = Metric::Matrix;
+    if (weightType == "EUC_2D")
+        metric = Metric::Euclidean;
+    else if (weightType == "GEO")
+        metric = Metric::Geo;
+    else if (weightType == "ATT")
+        metric = Metric::Att;
+    else if (weightType != "EXPLICIT")
+        throw std::runtime_error("Unsupported EDGE_WEIGHT_TYPE " + weightType + " in " + filename);
+    if (metric != Metric::Matrix && !hasCoordinates)
+        throw std::runtime_error("Missing NODE_COORD_SECTION in " + filename);
+    if (metric == Metric::Matrix && !hasWeights)
+        throw std::runtime_error("Missing EDGE_WEIGHT_SECTION in " + filename);
+
+    // explicit matrices are indexed by file order, so only coordinate instances can be renumbered
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    bool reorder = options.reorder != Curve::None && metric != Metric::Matrix;
+    if (reorder) {
+        TRACE_SPAN("curve reorder", "load");
+        order = SpaceFillingCurve::order(xs, ys, options.reorder);
+    }
+
+    {
+        TRACE_SPAN("create vertices", "load");
+        startStage(progress, LoadStage::Vertices, n);
+        g->reserve(n);
+        std::vector<double> orderedX(xs.size()), orderedY(ys.size());
+        for (int k = 0; k < n; k++) {
+            advance(progress, 1);
+            double x = hasCoordinates ? xs[order[k]] : 0, y = hasCoordinates ? ys[order[k]] : 0;
+            // GEO coordinates are latitude first
+            if (metric == Metric::Geo)
+                g->addVertex(k, y, x);
+            else
+                g->addVertex(k, x, y);
+            if (hasCoordinates) {
+                orderedX[k] = x;
+                orderedY[k] = y;
+            }
+        }
+        if (reorder)
+            g->setOriginalIds(order);
+        if (metric != Metric::Matrix)
+            g->setCoordinates(metric, orderedX, orderedY);
+    }
+    if (progress != nullptr && metric != Metric::Matrix)
+        progress->verticesReady(g);
+    startStage(progress, LoadStage::Done, 0);
+    return name;
+}
+
+/**
+ * @brief Reads a TSPLIB tour (.tour) of a graph loaded with readTsplib
+ * @param g The main graph
+ * @param filename file to read
+ * @return vertex infos of the tour, without repeating the first one
+ * @throws std::runtime_error if the file can not be read or the tour is not a permutation of the vertices
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+std::vector<int> Auxiliar::readTour(Graph *g, const std::string &filename) {
+    TRACE_SPAN("readTour", "load");
+    TokenReader in(filename);
+    std::vector<int> tour;
+    while (true) {
+        std::string_view t = in.token();
+        if (t.empty() || t == "EOF")
+            break;
+        if (t != "TOUR_SECTION") {
+            in.line();
+            continue;
+        }
+        while (true) {
+            int id = in.integer();
+            if (id == -1)
+                break;
+            int info = g->getInternalId(id - 1);
+            if (info < 0 || g->findVertex(info) == nullptr)
+                throw std::runtime_error("Node " + std::to_string(id) + " of " + filename + " is not in the graph");
+            tour.push_back(info);
+        }
+    }
+
+    std::vector<char> seen(g->getNumVertex(), 0);
+    for (int info : tour) {
+        int idx = g->findVertexIdx(info);
+        if (seen[idx]++)
+            throw std::runtime_error("Node " + std::to_string(g->getOriginalId(info) + 1) + " repeats in " + filename);
+    }
+    if (tour.size() != (size_t) g->getNumVertex())
+        throw std::runtime_error(filename + " visits " + std::to_string(tour.size()) + " of the " +
+                                 std::to_string(g->getNumVertex()) + " nodes");
+    return tour;
+}
+
+/**
+ * @brief Writes the graph as a TSPLIB instance: coordinate graphs with their distance type, matrix graphs as an
+ * explicit full matrix
+ * @param g The main graph, with infos 0..v-1
+ * @param filename file to write
+ * @param name name of the instance
+ * @throws std::runtime_error if the file can not be written
+ * @details Time Complexity O(v) for coordinates, O(v²) for matrices -> v: number of vertices
+ */
+void Auxiliar::writeTsplib(Graph *g, const std::string &filename, const std::string &name) {
+    std::ofstream out(filename);
+    if (!out)
+        throw std::runtime_error("Could not write " + filename);
+    int n = g->getNumVertex();
+    std::vector<Vertex *> byOriginal(n, nullptr);
+    for (Vertex *v : g->getVertexSet())
+        byOriginal[g->getOriginalId(v->getInfo())] = v;
+
+    out << "NAME : " << name << "\nTYPE : TSP\nDIMENSION : " << n << "\n";
+    out.precision(17);
+    Metric metric = g->getMetric();
+    if (metric == Metric::Matrix) {
+        out << "EDGE_WEIGHT_TYPE : EXPLICIT\nEDGE_WEIGHT_FORMAT : FULL_MATRIX\nEDGE_WEIGHT_SECTION\n";
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++)
+                out << (j ? " " : "") << g->getDist(byOriginal[i]->getInfo(), byOriginal[j]->getInfo());
+            out << "\n";
+        }
+    } else {
+        out << "EDGE_WEIGHT_TYPE : " << (metric == Metric::Euclidean ? "EUC_2D" : metric == Metric::Geo ? "GEO" : "ATT")
+            << "\nNODE_COORD_SECTION\n";
+        for (int i = 0; i < n; i++) {
+            Vertex *v = byOriginal[i];
+            if (metric == Metric::Geo)
+                out << i + 1 << " " << v->getLat() << " " << v->getLon() << "\n";
+            else
+                out << i + 1 << " " << v->getLon() << " " << v->getLat() << "\n";
+        }
+    }
+    out << "EOF\n";
+}
+
+/**
+ * @brief Writes a tour in the TSPLIB format, with the node numbers of the file the graph was read from
+ * @param g The main graph
+ * @param filename file to write
+ * @param name name of the tour
+ * @param tour vertex infos of the tour, without repeating the first one
+ * @throws std::runtime_error if the file can not be written
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+void Auxiliar::writeTour(Graph *g, const std::string &filename, const std::string &name, const std::vector<int> &tour) {
+    std::ofstream out(filename);
+    if (!out)
+        throw std::runtime_error("Could not write " + filename);
+    out << "NAME : " << name << "\nTYPE : TOUR\nDIMENSION : " << tour.size() << "\nTOUR_SECTION\n";
+    for (int info : tour)
+        out << g->getOriginalId(info) + 1 << "\n";
+    out << "-1\nEOF\n";
+}
+
+/**
+ * @brief Fills every missing (zero) distance of the matrix with the haversine distance between the two vertices.
+ * Rows are split in blocks processed by the thread pool. Each pair (i, j) with j < i is owned by row i, which writes
+ * both [i][j] and [j][i], so there are no write races and the result does not depend on the number of threads.
+ * @param g graph whose vertices have infos 0..n-1
+ * @param n number of vertices
+ * @param progress where the progress is reported and cancellation is checked, nullptr for neither
+ * @throws LoadCancelled if the load is cancelled through progress; the blocks left are skipped
+ * @details Time Complexity O(v²/t) -> v: number of vertices, t: number of threads
+ */
+void Auxiliar::completeMatrix(Graph *g, int n, LoadProgress *progress) {
+    STATS_TIMER(Phase::MatrixFill);
+    TRACE_SPAN("haversine fill", "load");
+
+    std::vector<Vertex *> byInfo(n, nullptr);
+    for (Vertex *v : g->getVertexSet()) {
+        if (v->getInfo() >= 0 && v->getInfo() < n)
+            byInfo[v->getInfo()] = v;
+    }
+
+    startStage(progress, LoadStage::Matrix, n > 1 ? n - 1 : 0);
+    // later rows are longer, small blocks keep the threads balanced
+    ThreadPool::global().parallelFor(1, n, 32, [&](int lo, int hi) {
+        // a cancelled load skips its remaining blocks, throwing here would escape the pool
+        if (progress != nullptr && progress->isCancelled())
+            return;
+        TRACE_SPAN("haversine rows", "load");
+        if (progress != nullptr)
+            progress->advance(hi - lo);
+        for (int i = lo; i < hi; i++) {
+            if (byInfo[i] == nullptr)
+                continue;
+            for (int j = 0; j < i; j++) {
+                if (byInfo[j] != nullptr && g->getDist(i, j) == 0)
+                    g->addToDistMatrix(i, j, Management::getHaversineDist(byInfo[i], byInfo[j]));
+            }
+        }
+    });
+    if (progress != nullptr)
+        progress->check();
+}
+
+/**
+ * @brief Fills the missing (zero) distances of a vertex added after loading with the haversine distance, as
+ * completeMatrix does for the whole matrix at load time. On a graph without coordinates the distance to a vertex is
+ * instead the shortest way there through one of the edges of the new vertex, if the other end of the edge has a
+ * distance to it. Graphs whose distances come from coordinates need nothing.
+ * @param g The main graph
+ * @param in info of the vertex, whose edges are already added
+ * @param coordinates whether the graph had coordinates before the vertex was added (see Graph::hasCoordinates)
+ * @details Time Complexity O(v d) -> v: number of vertices, d: degree of the new vertex
+ */
+void Auxiliar::completeVertex(Graph *g, int in, bool coordinates) {
+    Vertex *v = g->findVertex(in);
+    if (v == nullptr || g->getMetric() != Metric::Matrix)
+        return;
+    for (Vertex *u : g->getVertexSet()) {
+        if (u == v || g->getDist(in, u->getInfo()) != 0)
+            continue;
+        if (coordinates) {
+            g->addToDistMatrix(in, u->getInfo(), Management::getHaversineDist(v, u));
+            continue;
+        }
+        double best = INF;
+        for (Edge *e : v->getAdj()) {
+            double rest = g->getDist(e->getDest()->getInfo(), u->getInfo());
+            if (rest > 0 && rest < INF)
+                best = std::min(best, e->getWeight() + rest);
         }
+        if (best < INF)
+            g->addToDistMatrix(in, u->getInfo(), best);
     }
 }
@@ -1,17 +1,96 @@
 #ifndef PROJECT2_AUXILIAR_H
 #define PROJECT2_AUXILIAR_H
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include "Graph.h"
+#include "SpaceFillingCurve.h"
+
+/**
+ * @brief Optional transformations applied while loading a dataset
+ */
+struct LoadOptions {
+    Curve reorder = Curve::None;    // renumber the vertices of coordinate graphs along this curve
+    bool tiled = false;             // store the distance matrix in cache-sized tiles
+};
+
+/**
+ * @brief Stages of loading a dataset, in the order they run
+ */
+enum class LoadStage {
+    Parse,      // reading the files and adding the edges
+    Vertices,   // creating the vertices
+    Matrix,     // filling the missing distances of the matrix
+    Done
+};
+
+/**
+ * @brief Thrown by the readers when the load they are doing is cancelled
+ */
+class LoadCancelled : public std::runtime_error {
+public:
+    LoadCancelled() : std::runtime_error("Loading cancelled") {}
+};
+
+/**
+ * @brief Progress of a load, written by the thread reading the dataset and read by any other thread.
+ * Cancelling only raises a flag: the readers notice it at their next check and throw LoadCancelled.
+ * Readers of coordinate datasets also announce when every vertex exists, so work that only needs the vertices can
+ * start while the rest of the file is parsed.
+ */
+class LoadProgress {
+public:
+    void setOnVertices(std::function<void(Graph *)> callback);
+    void verticesReady(Graph *g);
+
+    void start(LoadStage stage, size_t total);
+    void advance(size_t amount);
+    void check() const;
+    void cancel();
+    bool isCancelled() const;
+    LoadStage getStage() const;
+    std::string describe() const;
+
+private:
+    std::atomic<LoadStage> stage{LoadStage::Parse};
+    std::atomic<size_t> done{0};
+    std::atomic<size_t> total{0};
+    std::atomic<bool> cancelled{false};
+    std::function<void(Graph *)> onVertices;
+};
 
 /**
  * @brief Auxiliary class to read files
  */
 class Auxiliar {
 public:
-    static void readDataset(Graph *g, int dataset = 0);
-    static void readSmall(Graph *g, std::string filename);
-    static void readMedium(Graph *g, std::string filename);
-    static void readLarge(Graph *g, std::string filename);
+    /**
+     * @brief Number of datasets in the table of datasetPath, numbered 0 to NUM_DATASETS - 1
+     */
+    static const int NUM_DATASETS = 18;
+
+    static void setLoadOptions(const LoadOptions &newOptions);
+    static LoadOptions getLoadOptions();
+
+    static void readDataset(Graph *g, int dataset = 0, LoadProgress *progress = nullptr);
+    static std::string datasetPath(int dataset);
+    static std::vector<std::string> datasetFiles(int dataset);
+    static void readSmall(Graph *g, std::string filename, LoadProgress *progress = nullptr);
+    static void readMedium(Graph *g, std::string filename, LoadProgress *progress = nullptr);
+    static void readLarge(Graph *g, std::string filename, LoadProgress *progress = nullptr);
+    static std::string readTsplib(Graph *g, const std::string &filename, LoadProgress *progress = nullptr);
+    static std::vector<int> readTour(Graph *g, const std::string &filename);
+    static void writeTsplib(Graph *g, const std::string &filename, const std::string &name);
+    static void writeTour(Graph *g, const std::string &filename, const std::string &name, const std::vector<int> &tour);
     static double** initMatrix(int n);
+    static void completeMatrix(Graph *g, int n, LoadProgress *progress = nullptr);
+    static void completeVertex(Graph *g, int in, bool coordinates);
+
+private:
+    static LoadOptions options;
 
 };
 
@@ -0,0 +1,108 @@
+#include "Candidates.h"
+#include "Graph.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+/**
+ * @brief Builds the k-nearest lists, scanning the rows of the distance matrix or the edges of the vertices in parallel
+ * @param graph graph with a complete distance matrix
+ * @param k neighbours per vertex, capped at v - 1
+ * @param source where the neighbours come from
+ * @param stop if not null, once set the rows not scanned yet are left empty, for a caller that gave up on the lists
+ * @details Time Complexity O(v² / t) from the matrix, O((v + e log(k)) / t) from the edges -> v: number of vertices,
+ * e: number of edges, t: number of threads
+ */
+CandidateLists::CandidateLists(Graph *graph, int k, CandidateSource source, const std::atomic<bool> *stop)
+        : graph(graph) {
+    TRACE_SPAN("candidate lists", "solve");
+    auto vertices = graph->getVertexSet();
+    n = vertices.size();
+    this->k = std::max(0, std::min(k, n - 1));
+
+    infos.resize(n);
+    for (int i = 0; i < n; i++)
+        infos[i] = vertices[i]->getInfo();
+
+    std::unordered_map<int, int> index;
+    if (source == CandidateSource::Edges) {
+        index.reserve(n);
+        for (int i = 0; i < n; i++)
+            index[infos[i]] = i;
+    }
+
+    neighbours.assign((size_t) n * this->k, -1);
+    counts.assign(n, 0);
+    // the same blocks of rows as the matrix allocation, so each thread scans rows in the memory of its own NUMA node
+    ThreadPool::global().parallelForBlocks(0, n, [&](int lo, int hi) {
+        std::vector<std::pair<double, int>> row;
+        for (int i = lo; i < hi; i++) {
+            if (stop != nullptr && *stop)
+                return;
+            row.clear();
+            if (source == CandidateSource::Matrix) {
+                for (int j = 0; j < n; j++) {
+                    if (j != i)
+                        row.emplace_back(graph->getDist(infos[i], infos[j]), j);
+                }
+            } else {
+                for (Edge *e : vertices[i]->getAdj()) {
+                    int j = index.at(e->getDest()->getInfo());
+                    if (j != i)
+                        row.emplace_back(e->getWeight(), j);
+                }
+                // parallel edges would take two slots
+                std::sort(row.begin(), row.end(), [](const auto &a, const auto &b) {
+                    return a.second != b.second ? a.second < b.second : a.first < b.first;
+                });
+                row.erase(std::unique(row.begin(), row.end(), [](const auto &a, const auto &b) {
+                    return a.second == b.second;
+                }), row.end());
+            }
+            int count = std::min<int>(this->k, row.size());
+            std::partial_sort(row.begin(), row.begin() + count, row.end());
+            for (int r = 0; r < count; r++)
+                neighbours[(size_t) i * this->k + r] = row[r].second;
+            counts[i] = count;
+        }
+    });
+    Memory::noteScratch((neighbours.capacity() + counts.capacity() + infos.capacity()) * sizeof(int));
+}
+
+/**
+ * @brief Number of vertices
+ */
+int CandidateLists::size() const {
+    return n;
+}
+
+/**
+ * @brief Number of neighbours kept per vertex
+ */
+int CandidateLists::getK() const {
+    return k;
+}
+
+/**
+ * @brief Nearest neighbours of a vertex, closest first
+ * @param v index of the vertex in the vertex set
+ */
+std::span<const int> CandidateLists::of(int v) const {
+    return {neighbours.data() + (size_t) v * k, (size_t) counts[v]};
+}
+
+/**
+ * @brief Info of the vertex with index v in the vertex set
+ */
+int CandidateLists::getInfo(int v) const {
+    return infos[v];
+}
+
+/**
+ * @brief Distance between the vertices with indices v and w in the vertex set
+ */
+double CandidateLists::dist(int v, int w) const {
+    return graph->getDist(infos[v], infos[w]);
+}
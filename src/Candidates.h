@@ -0,0 +1,45 @@
+#ifndef PROJECT2_CANDIDATES_H
+#define PROJECT2_CANDIDATES_H
+
+#include <atomic>
+#include <span>
+#include <vector>
+
+class Graph;
+
+/**
+ * @brief Where the candidate neighbours of a vertex come from
+ */
+enum class CandidateSource {
+    // nearest vertices by the distance matrix
+    Matrix,
+    // cheapest edges of the vertex, so only pairs the graph connects are candidates
+    Edges
+};
+
+/**
+ * @brief k-nearest neighbour lists of the vertices of a graph, the candidate edges of the construction heuristics.
+ * Vertices are referred to by their index in the vertex set; the lists are stored in one flat array, k slots per
+ * vertex, closest first. Lists built from edges can be shorter than k.
+ */
+class CandidateLists {
+public:
+    CandidateLists(Graph *graph, int k, CandidateSource source = CandidateSource::Matrix,
+                   const std::atomic<bool> *stop = nullptr);
+
+    int size() const;
+    int getK() const;
+    std::span<const int> of(int v) const;
+    int getInfo(int v) const;
+    double dist(int v, int w) const;
+
+private:
+    Graph *graph;
+    int n;
+    int k;
+    std::vector<int> neighbours;
+    std::vector<int> counts;
+    std::vector<int> infos;
+};
+
+#endif //PROJECT2_CANDIDATES_H
@@ -0,0 +1,220 @@
+#include "DatasetLoader.h"
+#include "Management.h"
+#include "ResultCache.h"
+#include "Trace.h"
+
+#include <chrono>
+#include <ostream>
+
+/**
+ * @brief Starts loading on a thread of its own. The pool is left to the parallel parts of the load and to solvers.
+ * @param read function that reads the dataset
+ */
+DatasetLoader::DatasetLoader(ReadFunction read)
+        : future(promise.get_future().share()), started(std::chrono::steady_clock::now()) {
+    progress.setOnVertices([this](Graph *g) { buildEarlyTour(g); });
+    thread = std::thread(&DatasetLoader::load, this, std::move(read));
+}
+
+/**
+ * @brief Cancels the load if it is still running and waits for the thread. The graph is deleted unless it was taken.
+ */
+DatasetLoader::~DatasetLoader() {
+    cancel();
+    thread.join();
+    earlyTour.wait();
+    if (!taken && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        try {
+            delete future.get();
+        } catch (const std::exception &) {
+        }
+    }
+}
+
+/**
+ * @brief Reader of one of the datasets of the menu
+ * @param dataset index of the dataset
+ */
+DatasetLoader::ReadFunction DatasetLoader::dataset(int dataset) {
+    return [dataset](Graph *g, LoadProgress *progress) {
+        Auxiliar::readDataset(g, dataset, progress);
+        return Source{"", Auxiliar::datasetFiles(dataset)};
+    };
+}
+
+/**
+ * @brief Reader of a TSPLIB instance
+ * @param filename path of the .tsp file
+ */
+DatasetLoader::ReadFunction DatasetLoader::tsplib(const std::string &filename) {
+    return [filename](Graph *g, LoadProgress *progress) {
+        return Source{Auxiliar::readTsplib(g, filename, progress), {filename}};
+    };
+}
+
+/**
+ * @brief Body of the loading thread: reads into a new graph and fulfils the promise with it, or with the error
+ */
+void DatasetLoader::load(ReadFunction read) {
+    Trace::setThreadName("loader");
+    StatsSnapshot before = Stats::collect();
+    Graph *g = new Graph();
+    try {
+        Source source = read(g, &progress);
+        name = source.name;
+        // only read the files again when there is a cache to look the dataset up in
+        // the load options change the vertex order the heuristics see, so they are part of the key
+        if (ResultCache::enabled()) {
+            LoadOptions options = Auxiliar::getLoadOptions();
+            std::string variant;
+            if (options.reorder != Curve::None)
+                variant += "reorder=" + SpaceFillingCurve::name(options.reorder) + ";";
+            if (options.tiled)
+                variant += "tiled;";
+            checksum = ResultCache::checksum(source.files, variant);
+        }
+        stats = Stats::collect() - before;
+        loadMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+        promise.set_value(g);
+    } catch (...) {
+        // the early tour reads the vertices, it must be done before they are deleted
+        earlyTour.wait();
+        delete g;
+        promise.set_exception(std::current_exception());
+    }
+}
+
+/**
+ * @brief Starts the space-filling curve tour on the pool, while the loading thread goes on with the edges. Without
+ * workers in the pool it is built right away on the loading thread.
+ * @param g graph whose vertices are final
+ */
+void DatasetLoader::buildEarlyTour(Graph *g) {
+    earlyTour.run([this, g]() {
+        TRACE_SPAN("early tour", "solve");
+        // a failure only means there is no early tour, the algorithms then build their own
+        try {
+            earlyTourResult = Management::curveTour(g);
+        } catch (const std::exception &) {
+            return;
+        }
+        earlyTourMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - started).count();
+    });
+}
+
+/**
+ * @brief Asks the load to stop. The future then holds a LoadCancelled, unless the load had already finished.
+ */
+void DatasetLoader::cancel() {
+    progress.cancel();
+}
+
+bool DatasetLoader::isReady() const {
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+std::shared_future<Graph *> DatasetLoader::getFuture() const {
+    return future;
+}
+
+/**
+ * @brief Waits for the load and hands the graph over to the caller, who deletes it
+ * @return the loaded graph
+ * @throws std::runtime_error the error the load failed with
+ */
+Graph *DatasetLoader::take() {
+    Graph *g = future.get();
+    // the caller may delete the graph as soon as it has it, the early tour must not be reading it by then
+    earlyTour.wait();
+    taken = true;
+    return g;
+}
+
+/**
+ * @brief Waits for the load, rewriting a progress line on out while it runs
+ * @param out stream the progress line is written to
+ * @return true if the load succeeded
+ */
+bool DatasetLoader::waitWithProgress(std::ostream &out) {
+    bool shown = false;
+    while (future.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+        out << "\rLoading the dataset: " << progress.describe();
+        long ms = earlyTourMs;
+        if (ms >= 0)
+            out << ", first route ready after " << ms << "ms";
+        out << "   " << std::flush;
+        shown = true;
+    }
+    if (shown)
+        out << "\n";
+    try {
+        future.get();
+        return true;
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+const LoadProgress &DatasetLoader::getProgress() const {
+    return progress;
+}
+
+/**
+ * @brief Name the reader gave the dataset, empty for the datasets of the menu. Only valid once the load is ready.
+ */
+std::string DatasetLoader::getName() const {
+    return name;
+}
+
+/**
+ * @brief Checksum of the files the dataset was read from, which identifies it in the result cache. Only valid once
+ * the load is ready, and 0 when the cache is off.
+ */
+uint64_t DatasetLoader::getChecksum() const {
+    return checksum;
+}
+
+/**
+ * @brief Counters recorded while loading. Only valid once the load is ready.
+ */
+StatsSnapshot DatasetLoader::getStats() const {
+    return stats;
+}
+
+/**
+ * @brief Time from the start of the load until the graph was ready. Only valid once the load is ready.
+ */
+long DatasetLoader::getLoadMs() const {
+    return loadMs;
+}
+
+/**
+ * @brief Space-filling curve tour built from the coordinates while the load ran, waiting for it if needed
+ * @return vertex infos of the tour starting at node 0 of the dataset, empty if the dataset has no coordinates
+ */
+std::vector<int> DatasetLoader::getEarlyTour() {
+    earlyTour.wait();
+    return earlyTourResult;
+}
+
+/**
+ * @brief Space-filling curve tour built from the coordinates, without waiting for it, so it can be used while the
+ * edges are still being read
+ * @param tour set to the vertex infos of the tour if it is ready
+ * @return true if the tour is ready
+ */
+bool DatasetLoader::pollEarlyTour(std::vector<int> &tour) const {
+    // the tour is written before the time, so a time set means the tour is complete
+    if (earlyTourMs < 0)
+        return false;
+    tour = earlyTourResult;
+    return true;
+}
+
+/**
+ * @brief Time from the start of the load until the early tour was ready, -1 if there is none yet
+ */
+long DatasetLoader::getEarlyTourMs() const {
+    return earlyTourMs;
+}
@@ -0,0 +1,89 @@
+#ifndef PROJECT2_DATASETLOADER_H
+#define PROJECT2_DATASETLOADER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <atomic>
+
+#include "Auxiliar.h"
+#include "Stats.h"
+#include "ThreadPool.h"
+
+/**
+ * @brief Loads a dataset into a new graph on a background thread, so the menu stays usable while it loads.
+ * Solvers wait on the future of the graph, the progress can be read at any time, and a load that is no longer wanted
+ * can be cancelled.
+ * For coordinate datasets, a space-filling curve tour is built on another thread as soon as the vertices exist, so a
+ * first route is ready while the edges are still being parsed and the matrix filled.
+ */
+class DatasetLoader {
+public:
+    /**
+     * @brief What a reader tells about the dataset it read: its name, empty for the datasets of the menu, and the
+     * files it came from
+     */
+    struct Source {
+        std::string name;
+        std::vector<std::string> files;
+    };
+
+    /**
+     * @brief Reads a dataset into an empty graph, reporting to the progress
+     */
+    using ReadFunction = std::function<Source(Graph *, LoadProgress *)>;
+
+    explicit DatasetLoader(ReadFunction read);
+    ~DatasetLoader();
+
+    DatasetLoader(const DatasetLoader &) = delete;
+    DatasetLoader &operator=(const DatasetLoader &) = delete;
+
+    static ReadFunction dataset(int dataset);
+    static ReadFunction tsplib(const std::string &filename);
+
+    void cancel();
+    bool isReady() const;
+    std::shared_future<Graph *> getFuture() const;
+    Graph *take();
+    bool waitWithProgress(std::ostream &out);
+
+    const LoadProgress &getProgress() const;
+    std::string getName() const;
+    uint64_t getChecksum() const;
+    StatsSnapshot getStats() const;
+    long getLoadMs() const;
+
+    std::vector<int> getEarlyTour();
+    bool pollEarlyTour(std::vector<int> &tour) const;
+    long getEarlyTourMs() const;
+
+private:
+    void load(ReadFunction read);
+    void buildEarlyTour(Graph *g);
+
+    LoadProgress progress;
+    std::promise<Graph *> promise;
+    std::shared_future<Graph *> future;
+    std::thread thread;
+    bool taken = false;
+    std::chrono::steady_clock::time_point started;
+
+    // written by the loading thread before the future becomes ready
+    std::string name;
+    uint64_t checksum = 0;
+    StatsSnapshot stats;
+    long loadMs = 0;
+
+    // tour of the vertex infos built from the coordinates alone, and when it was ready
+    TaskGroup earlyTour;
+    std::vector<int> earlyTourResult;
+    std::atomic<long> earlyTourMs{-1};
+};
+
+#endif //PROJECT2_DATASETLOADER_H
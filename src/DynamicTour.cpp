@@ -0,0 +1,411 @@
+#include "DynamicTour.h"
+#include "Graph.h"
+#include "Management.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// smallest gain a move must have to be made, so rounding errors do not make moves cycle
+const double EPS = 1e-7;
+
+}
+
+/**
+ * @brief Starts from a tour found by any of the solvers
+ * @param graph graph of the tour, whose distances the updates change
+ * @param tour vertex infos, without repeating the first one
+ * @param options window of the local search
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+DynamicTour::DynamicTour(Graph *graph, const std::vector<int> &tour, const DynamicTourOptions &options)
+        : graph(graph), options(options), order(tour) {
+    int largest = tour.empty() ? -1 : *std::max_element(tour.begin(), tour.end());
+    pos.assign(largest + 1, -1);
+    for (int i = 0; i < (int) order.size(); i++)
+        pos[order[i]] = i;
+    cost = Management::tourCost(graph, order);
+}
+
+/**
+ * @brief Adds a vertex of the graph to the tour, between the two consecutive vertices where it costs the least, and
+ * repairs the tour around it
+ * @param in info of a vertex whose distances to the others are already set
+ * @return Cost of the repaired tour, the same tour if the vertex was already on it
+ * @details Time Complexity O(v + m w²) -> v: number of vertices, m: improving moves, w: window
+ */
+double DynamicTour::insert(int in) {
+    TRACE_SPAN("DynamicTour insert", "solve");
+    if (contains(in))
+        return cost;
+    int n = order.size();
+    int best = n;
+    double bestDelta = INF;
+    for (int i = 0; i < n && n > 1; i++) {
+        int a = order[i], b = order[(i + 1) % n];
+        double delta = dist(a, in) + dist(in, b) - dist(a, b);
+        if (delta < bestDelta) {
+            bestDelta = delta;
+            best = i + 1;
+        }
+    }
+    insertAt(best, in);
+    cost += n > 1 ? bestDelta : 0;
+    repair({in});
+    return cost;
+}
+
+/**
+ * @brief Takes a vertex out of the tour, joining its two neighbours, and repairs the tour around them
+ * @param in info of the vertex
+ * @return Cost of the repaired tour, the same tour if the vertex was not on it
+ * @details Time Complexity O(v + m w²) -> v: number of vertices, m: improving moves, w: window
+ */
+double DynamicTour::remove(int in) {
+    TRACE_SPAN("DynamicTour remove", "solve");
+    if (!contains(in))
+        return cost;
+    int p = pos[in];
+    int prev = at(p - 1), next = at(p + 1);
+    cost -= dist(prev, in) + dist(in, next) - dist(prev, next);
+    eraseAt(p);
+    repair({prev, next});
+    return cost;
+}
+
+/**
+ * @brief Changes the distance between two vertices in the graph, moves each of them to its cheapest place in the tour
+ * if that pays, and repairs the tour around them
+ * @param v1 info of a vertex
+ * @param v2 info of another vertex
+ * @param w new distance between them
+ * @return Cost of the repaired tour
+ * @throws std::runtime_error if the distances of the graph are computed from coordinates
+ * @details Time Complexity O(v + m w²) -> v: number of vertices, m: improving moves, w: window
+ */
+double DynamicTour::changeWeight(int v1, int v2, double w) {
+    TRACE_SPAN("DynamicTour weight", "solve");
+    double old = dist(v1, v2);
+    if (!graph->setWeight(v1, v2, w))
+        throw std::runtime_error("the distances of this graph come from coordinates and can not be changed");
+    if (contains(v1) && contains(v2)) {
+        int p = pos[v1];
+        cost += ((at(p + 1) == v2) + (at(p - 1) == v2)) * (w - old);
+    }
+    std::vector<int> changed;
+    for (int v : {v1, v2}) {
+        if (contains(v)) {
+            relocate(v);
+            changed.push_back(v);
+        }
+    }
+    repair(changed);
+    return cost;
+}
+
+/**
+ * @brief Takes many vertices out of the tour in one pass, and repairs the tour around the vertices left next to the
+ * gaps, for the vertices of a batch of changes
+ * @param ins vertex infos, the ones not on the tour are ignored
+ * @return Cost of the repaired tour
+ * @details Time Complexity O(v + m w²) -> v: number of vertices, m: improving moves, w: window
+ */
+double DynamicTour::removeAll(const std::vector<int> &ins) {
+    TRACE_SPAN("DynamicTour remove", "solve");
+    std::vector<char> gone(order.size(), 0);
+    bool any = false;
+    for (int in : ins) {
+        if (contains(in)) {
+            gone[pos[in]] = 1;
+            any = true;
+        }
+    }
+    if (!any)
+        return cost;
+    std::vector<int> changed, kept;
+    int n = order.size();
+    for (int i = 0; i < n; i++) {
+        if (gone[i]) {
+            pos[order[i]] = -1;
+            continue;
+        }
+        // the ends of every gap
+        if (gone[(i + 1) % n] || gone[(i + n - 1) % n])
+            changed.push_back(order[i]);
+        kept.push_back(order[i]);
+    }
+    order = std::move(kept);
+    for (int i = 0; i < (int) order.size(); i++)
+        pos[order[i]] = i;
+    return refresh(changed);
+}
+
+/**
+ * @brief Recomputes the cost after distances changed outside of changeWeight, such as the edges of a batch of changes,
+ * and repairs the tour around the vertices whose distances changed
+ * @param changed vertex infos
+ * @return Cost of the repaired tour
+ * @details Time Complexity O(v + m w²) -> v: number of vertices, m: improving moves, w: window
+ */
+double DynamicTour::refresh(const std::vector<int> &changed) {
+    cost = Management::tourCost(graph, order);
+    repair(changed);
+    return cost;
+}
+
+/**
+ * @brief Follows a renumbering of the graph (see Graph::apply), once the vertices it removed are off the tour
+ * @param renumbered new info of every old info
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+void DynamicTour::renumber(const std::vector<int> &renumbered) {
+    for (int &in : order)
+        in = renumbered[in];
+    int largest = order.empty() ? -1 : *std::max_element(order.begin(), order.end());
+    pos.assign(largest + 1, -1);
+    for (int i = 0; i < (int) order.size(); i++)
+        pos[order[i]] = i;
+}
+
+/**
+ * @brief Cost of the tour, kept up to date by every update
+ */
+double DynamicTour::getCost() const {
+    return cost;
+}
+
+/**
+ * @brief Current tour
+ * @return vertex infos, starting at node 0 of the dataset if it is on the tour
+ */
+std::vector<int> DynamicTour::getTour() const {
+    std::vector<int> tour(order.size());
+    int start = contains(graph->getInternalId(0)) ? pos[graph->getInternalId(0)] : 0;
+    for (int i = 0; i < (int) order.size(); i++)
+        tour[i] = at(start + i);
+    return tour;
+}
+
+bool DynamicTour::contains(int in) const {
+    return in >= 0 && in < (int) pos.size() && pos[in] >= 0;
+}
+
+/**
+ * @brief Number of improving moves made by the repairs so far
+ */
+long DynamicTour::getMoves() const {
+    return moves;
+}
+
+double DynamicTour::dist(int a, int b) const {
+    return graph->getDist(a, b);
+}
+
+/**
+ * @brief Vertex at a position of the tour, taken modulo its length so the moves can index past either end
+ */
+int DynamicTour::at(long i) const {
+    long n = order.size();
+    return order[((i % n) + n) % n];
+}
+
+/**
+ * @brief Overwrites consecutive positions of the tour, from a position taken modulo its length
+ * @details Time Complexity O(k) -> k: number of items
+ */
+void DynamicTour::write(long from, const std::vector<int> &items) {
+    long n = order.size();
+    for (size_t k = 0; k < items.size(); k++) {
+        int i = ((from + (long) k) % n + n) % n;
+        order[i] = items[k];
+        pos[items[k]] = i;
+    }
+}
+
+/**
+ * @brief Inserts a vertex at a position, shifting the ones after it
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+void DynamicTour::insertAt(int p, int in) {
+    if (in >= (int) pos.size())
+        pos.resize(in + 1, -1);
+    order.insert(order.begin() + p, in);
+    for (int i = p; i < (int) order.size(); i++)
+        pos[order[i]] = i;
+}
+
+/**
+ * @brief Erases the vertex at a position, shifting the ones after it
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+void DynamicTour::eraseAt(int p) {
+    pos[order[p]] = -1;
+    order.erase(order.begin() + p);
+    for (int i = p; i < (int) order.size(); i++)
+        pos[order[i]] = i;
+}
+
+/**
+ * @brief Moves a vertex to the place in the whole tour where it costs the least, if that is cheaper than where it is
+ * @return true if the vertex was moved
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+bool DynamicTour::relocate(int in) {
+    int n = order.size();
+    if (n < 4)
+        return false;
+    int p = pos[in];
+    int prev = at(p - 1), next = at(p + 1);
+    double gain = dist(prev, in) + dist(in, next) - dist(prev, next);
+    int best = -1;
+    double bestDelta = gain - EPS;
+    for (int i = 0; i < n; i++) {
+        int a = order[i], b = order[(i + 1) % n];
+        if (a == in || b == in)
+            continue;
+        double delta = dist(a, in) + dist(in, b) - dist(a, b);
+        if (delta < bestDelta) {
+            bestDelta = delta;
+            best = a;
+        }
+    }
+    if (best < 0)
+        return false;
+    eraseAt(p);
+    insertAt(pos[best] + 1, in);
+    cost += bestDelta - gain;
+    moves++;
+    return true;
+}
+
+/**
+ * @brief Local search confined to the neighbourhood of the vertices that changed: 2-opt and or-opt moves around each
+ * of them, and around the ends of every move that improved the tour, until none does
+ * @param changed vertex infos to start from
+ * @details Time Complexity O(m w²) -> m: improving moves, w: window
+ */
+void DynamicTour::repair(std::vector<int> changed) {
+    if (order.size() < 5) {
+        // every tour of up to four vertices is a 2-opt optimum already, only the cost is recomputed
+        cost = Management::tourCost(graph, order);
+        return;
+    }
+    std::vector<char> queued(pos.size(), 0);
+    std::vector<int> stack;
+    for (int v : changed) {
+        if (contains(v) && !queued[v]) {
+            queued[v] = 1;
+            stack.push_back(v);
+        }
+    }
+    while (!stack.empty()) {
+        int v = stack.back();
+        stack.pop_back();
+        queued[v] = 0;
+        if (!contains(v))
+            continue;
+        std::vector<int> ends;
+        if (!twoOpt(v, ends) && !orOpt(v, ends))
+            continue;
+        ends.push_back(v);
+        for (int u : ends) {
+            if (!queued[u]) {
+                queued[u] = 1;
+                stack.push_back(u);
+            }
+        }
+    }
+}
+
+/**
+ * @brief First improving 2-opt move that replaces one of the two tour edges of a vertex and an edge within the window
+ * @param v vertex info
+ * @param changed where the ends of the move are added
+ * @return true if a move was made
+ * @details Time Complexity O(w) per try, plus O(w) for the reversal -> w: window
+ */
+bool DynamicTour::twoOpt(int v, std::vector<int> &changed) {
+    long n = order.size();
+    long window = std::min<long>(options.window, n - 2);
+    long p = pos[v];
+    for (long i : {p - 1, p}) {
+        for (long k = 2; k <= window; k++) {
+            for (long j : {i - k, i + k}) {
+                long lo = std::min(i, j), hi = std::max(i, j);
+                int a = at(lo), b = at(lo + 1), c = at(hi), d = at(hi + 1);
+                double delta = dist(a, c) + dist(b, d) - dist(a, b) - dist(c, d);
+                if (delta >= -EPS)
+                    continue;
+                // reverse b..c, which is at most the window long
+                std::vector<int> path;
+                for (long q = hi; q > lo; q--)
+                    path.push_back(at(q));
+                write(lo + 1, path);
+                cost += delta;
+                moves++;
+                changed.insert(changed.end(), {a, b, c, d});
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief First improving or-opt move: a run of up to maxSegment vertices holding the vertex is moved, either way
+ * round, between two consecutive vertices within the window
+ * @param v vertex info
+ * @param changed where the ends of the move are added
+ * @return true if a move was made
+ * @details Time Complexity O(s² w) per try, plus O(w) to rewrite the tour -> s: maxSegment, w: window
+ */
+bool DynamicTour::orOpt(int v, std::vector<int> &changed) {
+    long n = order.size();
+    long p = pos[v];
+    for (long len = 1; len <= options.maxSegment; len++) {
+        long window = std::min<long>(options.window, n - len - 1);
+        if (window < 1)
+            break;
+        for (long s = p - len + 1; s <= p; s++) {
+            long e = s + len - 1;
+            int prev = at(s - 1), first = at(s), last = at(e), next = at(e + 1);
+            double gain = dist(prev, first) + dist(last, next) - dist(prev, next);
+            for (long k = 1; k <= window; k++) {
+                // targets after the run (t = e + k) and before it (t = s - 1 - k)
+                for (long t : {e + k, s - 1 - k}) {
+                    int x = at(t), y = at(t + 1);
+                    if (x == prev && y == first)
+                        continue;
+                    double forward = dist(x, first) + dist(last, y) - dist(x, y);
+                    double backward = dist(x, last) + dist(first, y) - dist(x, y);
+                    double delta = std::min(forward, backward) - gain;
+                    if (delta >= -EPS)
+                        continue;
+                    std::vector<int> run, between;
+                    for (long q = s; q <= e; q++)
+                        run.push_back(at(q));
+                    if (backward < forward)
+                        std::reverse(run.begin(), run.end());
+                    if (t > e) {
+                        for (long q = e + 1; q <= t; q++)
+                            between.push_back(at(q));
+                        between.insert(between.end(), run.begin(), run.end());
+                        write(s, between);
+                    } else {
+                        for (long q = t + 1; q < s; q++)
+                            between.push_back(at(q));
+                        run.insert(run.end(), between.begin(), between.end());
+                        write(t + 1, run);
+                    }
+                    cost += delta;
+                    moves++;
+                    changed.insert(changed.end(), {prev, first, last, next, x, y});
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
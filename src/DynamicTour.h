@@ -0,0 +1,68 @@
+#ifndef PROJECT2_DYNAMICTOUR_H
+#define PROJECT2_DYNAMICTOUR_H
+
+#include <vector>
+
+class Graph;
+
+/**
+ * @brief Parameters of the incremental tour repair
+ */
+struct DynamicTourOptions {
+    // tour positions on each side of a changed vertex the local search looks at
+    int window = 50;
+    // longest run of vertices an or-opt move relocates
+    int maxSegment = 3;
+};
+
+/**
+ * @brief Tour kept across changes of the graph, so a few inserted or removed stops, or a changed distance, cost a
+ * repair of the tour instead of a solve from scratch.
+ *
+ * An inserted vertex goes where it adds the least to the tour (cheapest insertion); a removed one is spliced out; the
+ * ends of a changed distance are moved to their cheapest place if that pays. Then 2-opt and or-opt moves run around the
+ * vertices that changed, each one only against the tour positions within the window of it, and around the ends of
+ * every move that improved the tour, until none does. An update is O(v) for the insertion and the splice plus
+ * O(w²) per improving move -> v: number of vertices, w: window.
+ *
+ * The tour is kept as an array of vertex infos with the position of each, so moves within the window only rewrite
+ * that part of the array.
+ */
+class DynamicTour {
+public:
+    DynamicTour(Graph *graph, const std::vector<int> &tour, const DynamicTourOptions &options = {});
+
+    double insert(int in);
+    double remove(int in);
+    double changeWeight(int v1, int v2, double w);
+    double removeAll(const std::vector<int> &ins);
+    double refresh(const std::vector<int> &changed);
+    void renumber(const std::vector<int> &renumbered);
+
+    double getCost() const;
+    std::vector<int> getTour() const;
+    bool contains(int in) const;
+    long getMoves() const;
+
+private:
+    double dist(int a, int b) const;
+    int at(long i) const;
+    void write(long from, const std::vector<int> &items);
+    void insertAt(int p, int in);
+    void eraseAt(int p);
+    bool relocate(int in);
+
+    void repair(std::vector<int> changed);
+    bool twoOpt(int v, std::vector<int> &changed);
+    bool orOpt(int v, std::vector<int> &changed);
+
+    Graph *graph;
+    DynamicTourOptions options;
+    std::vector<int> order;
+    // position of each vertex info in order, -1 for the vertices not on the tour
+    std::vector<int> pos;
+    double cost = 0;
+    long moves = 0;
+};
+
+#endif //PROJECT2_DYNAMICTOUR_H
@@ -22,6 +22,18 @@ bool Edge::isSelected() const {
     return this->selected;
 }
 
+bool Edge::isRemoved() const {
+    return this->removed;
+}
+
+void Edge::setRemoved(bool removed) {
+    this->removed = removed;
+}
+
+void Edge::setWeight(double weight) {
+    this->weight = weight;
+}
+
 void Edge::setSelected(bool selected) {
     this->selected = selected;
 }
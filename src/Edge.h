@@ -16,16 +16,21 @@ public:
     Vertex * getOrig() const;
     Edge * getReverse() const;
     double getFlow() const;
+    bool isRemoved() const;
 
+    void setWeight(double weight);
     void setSelected(bool selected);
     void setReverse(Edge *reverse);
     void setFlow(double flow);
+    void setRemoved(bool removed);
 protected:
     Vertex * dest; // destination vertex
     double weight; // edge weight, can also be used for capacity
 
     // auxiliary fields
     bool selected = false;
+    // tombstone set while a batch of changes removes the edge, before it is dropped from the lists of its vertices
+    bool removed = false;
 
     // used for bidirectional edges
     Vertex *orig;
@@ -0,0 +1,378 @@
+#include "ExactSearch.h"
+#include "Graph.h"
+#include "LittleEndian.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+const char CHECKPOINT_MAGIC[4] = {'T', 'S', 'P', 'X'};
+const uint32_t CHECKPOINT_VERSION = 1;
+
+using LittleEndian::put;
+using LittleEndian::get;
+
+}
+
+/**
+ * @brief Builds the dense index adjacency of a graph
+ * @param graph graph to search, only its edges are followed
+ * @param startIdx index in the vertex set of the vertex where tours start and end
+ * @details Time Complexity O(v + e log(e)) -> v: number of vertices, e: number of edges
+ */
+ExactSearch::ExactSearch(Graph *graph, int startIdx) : graph(graph), start(startIdx), best(INF) {
+    auto vertices = graph->getVertexSet();
+    n = vertices.size();
+
+    std::unordered_map<int, int> index;
+    index.reserve(n);
+    for (int i = 0; i < n; i++)
+        index[vertices[i]->getInfo()] = i;
+
+    offset.assign(n + 1, 0);
+    closing.assign(n, INF);
+    minOut.assign(n, INF);
+    for (int i = 0; i < n; i++) {
+        for (Edge *e : vertices[i]->getAdj()) {
+            int j = index[e->getDest()->getInfo()];
+            arcs.push_back({j, e->getWeight()});
+            minOut[i] = std::min(minOut[i], e->getWeight());
+            if (j == start)
+                closing[i] = std::min(closing[i], e->getWeight());
+        }
+        offset[i + 1] = arcs.size();
+        // cheapest edges first, so good incumbents are found early and prune more
+        std::sort(arcs.begin() + offset[i], arcs.end(), [](const Arc &a, const Arc &b) {
+            return a.weight < b.weight;
+        });
+    }
+
+    visited.assign((n + 63) / 64, 0);
+    path.assign(n, 0);
+    cursor.assign(n, 0);
+    costAt.assign(n, 0);
+}
+
+bool ExactSearch::isVisited(int v) const {
+    return (visited[v >> 6] >> (v & 63)) & 1;
+}
+
+void ExactSearch::setVisited(int v, bool value) {
+    if (value)
+        visited[v >> 6] |= (uint64_t) 1 << (v & 63);
+    else
+        visited[v >> 6] &= ~((uint64_t) 1 << (v & 63));
+}
+
+/**
+ * @brief Seeds the search with a known tour, so branches that cannot beat it are pruned from the start
+ * @param cost cost of the tour, following the edges of the graph
+ * @param tour vertex infos of the tour, starting at the start vertex
+ * @details If nothing cheaper exists, run returns this cost and getBestTour this tour.
+ * Time Complexity O(v) -> v: number of vertices
+ */
+void ExactSearch::setIncumbent(double cost, const std::vector<int> &tour) {
+    if (cost >= best || (int) tour.size() != n)
+        return;
+
+    auto vertices = graph->getVertexSet();
+    std::unordered_map<int, int> index;
+    index.reserve(n);
+    for (int i = 0; i < n; i++)
+        index[vertices[i]->getInfo()] = i;
+
+    best = cost;
+    bestPath.clear();
+    for (int info : tour)
+        bestPath.push_back(index[info]);
+    // the search only builds tours from the start vertex, so store the incumbent rotated the same way
+    auto first = std::find(bestPath.begin(), bestPath.end(), start);
+    std::rotate(bestPath.begin(), first, bestPath.end());
+}
+
+/**
+ * @brief Prunes with the best cost found by other solvers as well, and publishes the tours found here to them
+ * @param sharedBound cost of the best tour known, lowered by every solver sharing it; nullptr to search alone
+ * @param sharedStop flag that ends the search when set; nullptr for none
+ * @details The shared costs must follow the edges of this graph, as the search prunes every branch that cannot beat
+ * them.
+ */
+void ExactSearch::share(std::atomic<double> *sharedBound, const std::atomic<bool> *sharedStop) {
+    bound = sharedBound;
+    stop = sharedStop;
+}
+
+/**
+ * @brief Stops the search after a time, with the best tour found so far
+ * @param limitMs time limit, 0 for none
+ */
+void ExactSearch::setTimeLimit(long limitMs) {
+    timeLimitMs = limitMs;
+}
+
+/**
+ * @brief Saves the search frontier to a file at regular intervals, and resumes from it if it holds a search of the
+ * same graph and start vertex
+ * @param file checkpoint file, empty for none. The fingerprint of the search is appended to it in hex, so searches of
+ * other graphs or start vertices keep checkpoints of their own instead of replacing each other's.
+ * @param intervalMs time between two checkpoints
+ */
+void ExactSearch::setCheckpoint(const std::string &file, long intervalMs) {
+    if (file.empty()) {
+        checkpointFile.clear();
+    } else {
+        std::ostringstream oss;
+        oss << file << "." << std::hex << fingerprint();
+        checkpointFile = oss.str();
+    }
+    checkpointIntervalMs = intervalMs;
+}
+
+/**
+ * @brief Whether the last run started from a checkpoint instead of the root of the search tree
+ */
+bool ExactSearch::wasResumed() const {
+    return resumed;
+}
+
+/**
+ * @brief Searches every Hamiltonian cycle through the start vertex, pruning branches that cannot beat the incumbent.
+ * The lower bound of a partial path is its cost plus the cheapest outgoing edge of the last vertex and of every
+ * unvisited vertex, since each of them still has to be left exactly once.
+ * With a checkpoint file, the search starts from the frontier saved there, saves it again every interval and when
+ * stopped, and removes the file when complete.
+ * @return Cost of the optimal tour, INF if there is none. If the search is stopped, the best tour found so far.
+ * @details Time Complexity O(v!) -> v: number of vertices
+ */
+double ExactSearch::run() {
+    complete = false;
+    resumed = false;
+    if (n == 0 || start < 0 || start >= n)
+        return INF;
+
+    double remainingMinOut = 0;
+    for (int v = 0; v < n; v++) {
+        if (minOut[v] == INF)
+            return INF;     // a vertex that cannot be left is never part of a tour
+        remainingMinOut += minOut[v];
+    }
+
+    std::fill(visited.begin(), visited.end(), 0);
+    setVisited(start, true);
+    path[0] = start;
+    cursor[0] = offset[start];
+    costAt[0] = 0;
+    int depth = 1;
+    if (!checkpointFile.empty() && loadCheckpoint(depth)) {
+        resumed = true;
+        // the cheapest way out of every vertex not left yet: all but the last of the path have been
+        for (int d = 0; d + 1 < depth; d++)
+            remainingMinOut -= minOut[path[d]];
+    }
+
+    // branches are pruned against the best tour found here or by the solvers sharing the bound
+    double limit = bound != nullptr ? std::min(best, bound->load()) : best;
+    auto now = std::chrono::steady_clock::now();
+    auto deadline = now + std::chrono::milliseconds(timeLimitMs);
+    auto nextCheckpoint = now + std::chrono::milliseconds(checkpointIntervalMs);
+    long steps = 0;
+
+    while (depth > 0) {
+        if ((++steps & 4095) == 0) {
+            now = std::chrono::steady_clock::now();
+            if ((stop != nullptr && *stop) || (timeLimitMs > 0 && now >= deadline)) {
+                if (!checkpointFile.empty())
+                    saveCheckpoint(depth);
+                return best;
+            }
+            if (!checkpointFile.empty() && now >= nextCheckpoint) {
+                saveCheckpoint(depth);
+                nextCheckpoint = now + std::chrono::milliseconds(checkpointIntervalMs);
+            }
+            if (bound != nullptr)
+                limit = std::min(limit, bound->load());
+        }
+        int v = path[depth - 1];
+
+        if (depth == n && closing[v] != INF && costAt[depth - 1] + closing[v] < limit) {
+            best = limit = costAt[depth - 1] + closing[v];
+            bestPath.assign(path.begin(), path.end());
+            if (bound != nullptr) {
+                double known = bound->load();
+                while (best < known && !bound->compare_exchange_weak(known, best));
+            }
+        }
+
+        // backtrack once the path is complete or every edge of v was tried
+        if (depth == n || cursor[depth - 1] == offset[v + 1]) {
+            setVisited(v, false);
+            if (depth > 1)
+                remainingMinOut += minOut[path[depth - 2]];
+            depth--;
+            continue;
+        }
+
+        const Arc &arc = arcs[cursor[depth - 1]++];
+        if (isVisited(arc.to))
+            continue;
+
+        // remainingMinOut still counts v, which is being left now through arc
+        double cost = costAt[depth - 1] + arc.weight;
+        if (cost + remainingMinOut - minOut[v] >= limit) {
+            STATS_INC(Counter::BacktrackingPruned);
+            continue;
+        }
+        STATS_INC(Counter::BacktrackingCalls);
+
+        setVisited(arc.to, true);
+        remainingMinOut -= minOut[v];
+        path[depth] = arc.to;
+        cursor[depth] = offset[arc.to];
+        costAt[depth] = cost;
+        depth++;
+    }
+
+    complete = true;
+    if (!checkpointFile.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(checkpointFile, ec);
+    }
+    return best;
+}
+
+/**
+ * @brief 64-bit FNV-1a hash of the start vertex and the arcs, in the order they are tried, so a checkpoint is only
+ * resumed by a search that would walk the same tree
+ * @details Time Complexity O(v + e) -> v: number of vertices, e: number of edges
+ */
+uint64_t ExactSearch::fingerprint() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t size) {
+        auto bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(&n, sizeof(n));
+    mix(&start, sizeof(start));
+    mix(offset.data(), offset.size() * sizeof(int));
+    for (const Arc &arc : arcs) {
+        mix(&arc.to, sizeof(arc.to));
+        mix(&arc.weight, sizeof(arc.weight));
+    }
+    return hash;
+}
+
+/**
+ * @brief Writes the frontier and the incumbent to the checkpoint file. The data goes to a temporary file first,
+ * which then replaces the checkpoint, so a process dying while writing leaves the previous checkpoint intact.
+ * Layout: magic, version, fingerprint, number of vertices, incumbent cost and path, depth, and for every depth the
+ * vertex, the next arc to try and the cost so far.
+ * @param depth number of vertices on the path
+ * @details Time Complexity O(v + e) -> v: number of vertices, e: number of edges
+ */
+void ExactSearch::saveCheckpoint(int depth) const {
+    std::string tmp = checkpointFile + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return;
+        out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        put<uint32_t>(out, CHECKPOINT_VERSION);
+        put<uint64_t>(out, fingerprint());
+        put<int32_t>(out, n);
+        put<double>(out, best);
+        put<uint32_t>(out, bestPath.size());
+        for (int v : bestPath)
+            put<int32_t>(out, v);
+        put<int32_t>(out, depth);
+        for (int d = 0; d < depth; d++) {
+            put<int32_t>(out, path[d]);
+            put<int32_t>(out, cursor[d]);
+            put<double>(out, costAt[d]);
+        }
+        if (!out)
+            return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, checkpointFile, ec);
+}
+
+/**
+ * @brief Restores the frontier from the checkpoint file, and its incumbent if cheaper than the current one
+ * @param depth set to the number of vertices on the restored path
+ * @return false, leaving the search untouched, if there is no checkpoint or it belongs to another search
+ * @details Time Complexity O(v + e) -> v: number of vertices, e: number of edges
+ */
+bool ExactSearch::loadCheckpoint(int &depth) {
+    std::ifstream in(checkpointFile, std::ios::binary);
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    uint32_t version, pathSize;
+    uint64_t hash;
+    int32_t vertices, savedDepth;
+    double savedBest;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), CHECKPOINT_MAGIC) ||
+        !get(in, version) || version != CHECKPOINT_VERSION || !get(in, hash) || hash != fingerprint() ||
+        !get(in, vertices) || vertices != n || !get(in, savedBest) || !get(in, pathSize) || pathSize > (uint32_t) n)
+        return false;
+    std::vector<int> savedPath(pathSize);
+    for (int &v : savedPath) {
+        int32_t value;
+        if (!get(in, value) || value < 0 || value >= n)
+            return false;
+        v = value;
+    }
+    if (!get(in, savedDepth) || savedDepth < 1 || savedDepth > n)
+        return false;
+    std::vector<int> newPath(savedDepth), newCursor(savedDepth);
+    std::vector<double> newCost(savedDepth);
+    for (int d = 0; d < savedDepth; d++) {
+        int32_t v, c;
+        if (!get(in, v) || !get(in, c) || !get(in, newCost[d]) || v < 0 || v >= n || c < offset[v] || c > offset[v + 1])
+            return false;
+        newPath[d] = v;
+        newCursor[d] = c;
+    }
+    if (newPath[0] != start)
+        return false;
+
+    std::fill(visited.begin(), visited.end(), 0);
+    for (int d = 0; d < savedDepth; d++) {
+        path[d] = newPath[d];
+        cursor[d] = newCursor[d];
+        costAt[d] = newCost[d];
+        setVisited(path[d], true);
+    }
+    depth = savedDepth;
+    if (savedBest < best && (int) savedPath.size() == n) {
+        best = savedBest;
+        bestPath = savedPath;
+    }
+    return true;
+}
+
+/**
+ * @brief Whether the last run searched every branch, so its tour is optimal, or, when it returned INF, there is none
+ * cheaper than the shared bound
+ */
+bool ExactSearch::isComplete() const {
+    return complete;
+}
+
+/**
+ * @brief Best tour found by the last run
+ * @return vertex infos of the tour, starting at the start vertex, empty if no tour was found
+ */
+std::vector<int> ExactSearch::getBestTour() const {
+    std::vector<int> tour;
+    auto vertices = graph->getVertexSet();
+    for (int idx : bestPath)
+        tour.push_back(vertices[idx]->getInfo());
+    return tour;
+}
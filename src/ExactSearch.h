@@ -0,0 +1,87 @@
+#ifndef PROJECT2_EXACTSEARCH_H
+#define PROJECT2_EXACTSEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Graph;
+
+/**
+ * @brief Iterative depth-first branch and bound over the edges of a graph.
+ * Runs on a dense index copy of the adjacency (CSR), keeps the visited set in a bitset and the search frontier on an
+ * explicit stack, looks up the edge closing the tour in O(1) and prunes against the incumbent with a lower bound.
+ *
+ * Since the whole frontier is the stack, a checkpoint is only the path, the next arc to try and the cost at every
+ * depth, plus the incumbent: O(v) bytes written every few minutes without stopping the search for longer than that
+ * write. A run on the same graph and start vertex picks up from the checkpoint, and the file is removed once the
+ * search is complete.
+ */
+class ExactSearch {
+public:
+    ExactSearch(Graph *graph, int startIdx);
+
+    void setIncumbent(double cost, const std::vector<int> &tour);
+    void share(std::atomic<double> *sharedBound, const std::atomic<bool> *sharedStop);
+    void setTimeLimit(long timeLimitMs);
+    double run();
+    std::vector<int> getBestTour() const;
+    bool isComplete() const;
+
+    void setCheckpoint(const std::string &file, long intervalMs);
+    bool wasResumed() const;
+
+private:
+    /**
+     * @brief Outgoing edge in index form
+     */
+    struct Arc {
+        int to;
+        double weight;
+    };
+
+    bool isVisited(int v) const;
+    void setVisited(int v, bool value);
+
+    uint64_t fingerprint() const;
+    void saveCheckpoint(int depth) const;
+    bool loadCheckpoint(int &depth);
+
+    Graph *graph;
+    int n;
+    int start;
+
+    // adjacency of vertex v is arcs[offset[v]..offset[v + 1]), sorted by weight
+    std::vector<int> offset;
+    std::vector<Arc> arcs;
+    // weight of the edge from each vertex back to the start, INF if there is none
+    std::vector<double> closing;
+    // cheapest outgoing edge of each vertex, used for the lower bound
+    std::vector<double> minOut;
+
+    std::vector<uint64_t> visited;
+
+    // explicit stack: vertex, next arc to try and cost so far at each depth
+    std::vector<int> path;
+    std::vector<int> cursor;
+    std::vector<double> costAt;
+
+    double best;
+    std::vector<int> bestPath;
+
+    // cost of the best tour known to the solvers running alongside, lowered by every one of them, and their stop flag
+    std::atomic<double> *bound = nullptr;
+    const std::atomic<bool> *stop = nullptr;
+    long timeLimitMs = 0;
+    // whether the last run searched the whole tree, so its tour is optimal
+    bool complete = false;
+
+    // file the frontier is saved to every checkpointIntervalMs, empty for none, and whether the last run resumed it
+    std::string checkpointFile;
+    long checkpointIntervalMs = 0;
+    bool resumed = false;
+};
+
+#endif //PROJECT2_EXACTSEARCH_H
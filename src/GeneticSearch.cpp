@@ -0,0 +1,260 @@
+#include "GeneticSearch.h"
+#include "Graph.h"
+#include "Management.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+/**
+ * @brief Builds the candidate lists and seeds every island
+ * @param graph graph with a complete distance matrix
+ * @param options parameters of the search
+ * @details Every island gets the nearest neighbour and the triangular approximation tours (and the initial tour of the
+ * options, if there is one), plus copies of them
+ * scrambled by random segment reversals and polished by the local search, so the islands start apart.
+ * Time Complexity O(v² + i p v) -> v: number of vertices, i: number of islands, p: population size
+ */
+GeneticSearch::GeneticSearch(Graph *graph, const GeneticOptions &options)
+        : graph(graph), options(options), cand(graph, 8), n(cand.size()) {
+    TRACE_SPAN("GeneticSearch seed", "solve");
+    best.cost = INF;
+    if (n < 4)
+        return;
+
+    // seed tours are built before any thread starts, since both heuristics write to the vertices
+    std::vector<int> nearest, triangular;
+    Management::tspOther(graph, &nearest);
+    Management::tspTriangular(graph, &triangular);
+    std::vector<std::vector<int>> seeds = {toIndices(nearest), toIndices(triangular)};
+    // an initial tour that is not a permutation of the vertices, e.g. one of a graph changed since, is left out
+    std::vector<int> initial = toIndices(options.initialTour);
+    if (!initial.empty())
+        seeds.push_back(initial);
+
+    cores = ThreadPool::global().getNumThreads();
+    int count = options.islands > 0 ? options.islands : cores;
+    this->options.populationSize = std::max(this->options.populationSize, 4);
+    islands.resize(count);
+    for (int i = 0; i < count; i++) {
+        Island &island = islands[i];
+        island.rng.seed(options.seed + i);
+        island.taken.resize(n);
+    }
+
+    ThreadPool::global().parallelFor(0, count, 1, [&](int lo, int hi) {
+        for (int i = lo; i < hi; i++) {
+            Island &island = islands[i];
+            for (int p = 0; p < this->options.populationSize; p++) {
+                Individual ind{seeds[p % seeds.size()], 0};
+                if (p >= (int) seeds.size()) {
+                    for (int r = 0; r < 1 + p / 4; r++) {
+                        int a = island.rng() % n, b = island.rng() % n;
+                        std::reverse(ind.tour.begin() + std::min(a, b), ind.tour.begin() + std::max(a, b) + 1);
+                    }
+                    localSearch(ind);
+                }
+                ind.cost = cost(ind.tour);
+                island.population.push_back(std::move(ind));
+            }
+        }
+    });
+}
+
+/**
+ * @brief Evolves the islands until the time limit, migrating the best tour of each island to the next one between
+ * epochs of migrationInterval generations
+ * @return Cost of the best tour found
+ * @details Time Complexity O(g p v k) -> g: generations, p: population size, v: number of vertices,
+ * k: candidates per vertex
+ */
+double GeneticSearch::run() {
+    TRACE_SPAN("GeneticSearch", "solve");
+    if (islands.empty()) {
+        // too small to evolve: every order of up to 3 vertices is the same cycle
+        std::vector<int> tour(n);
+        std::iota(tour.begin(), tour.end(), 0);
+        best = {tour, n > 1 ? cost(tour) : 0};
+        return best.cost;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(options.timeLimitMs);
+    do {
+        ThreadPool::global().parallelFor(0, islands.size(), 1, [&](int lo, int hi) {
+            for (int i = lo; i < hi; i++)
+                evolve(islands[i], options.migrationInterval);
+        });
+
+        // ring migration: the best of each island replaces the worst of the next one
+        std::vector<Individual> migrants;
+        for (Island &island : islands)
+            migrants.push_back(*std::min_element(island.population.begin(), island.population.end(),
+                                                 [](const Individual &a, const Individual &b) { return a.cost < b.cost; }));
+        for (size_t i = 0; i < islands.size(); i++)
+            insert(islands[(i + 1) % islands.size()], Individual(migrants[i]));
+    } while (std::chrono::steady_clock::now() < deadline && !(options.stop != nullptr && *options.stop));
+    elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    generations = 0;
+    for (Island &island : islands) {
+        generations += island.generations;
+        for (Individual &ind : island.population) {
+            if (ind.cost < best.cost)
+                best = ind;
+        }
+        Memory::noteScratch(island.population.size() * n * sizeof(int));
+    }
+    return best.cost;
+}
+
+/**
+ * @brief Runs generations on one island. A generation breeds as many children as the population has members, each
+ * from two tournament-selected parents, and keeps the children that beat the worst member.
+ * @param island island to evolve
+ * @param count number of generations
+ */
+void GeneticSearch::evolve(Island &island, int count) {
+    std::uniform_real_distribution<double> chance(0, 1);
+    for (int g = 0; g < count; g++) {
+        for (int c = 0; c < options.populationSize; c++) {
+            const Individual &a = island.population[select(island)];
+            const Individual &b = island.population[select(island)];
+            Individual child = crossover(island, a, b);
+            if (chance(island.rng) < options.mutationRate) {
+                int i = island.rng() % n, j = island.rng() % n;
+                std::reverse(child.tour.begin() + std::min(i, j), child.tour.begin() + std::max(i, j) + 1);
+            }
+            localSearch(child);
+            child.cost = cost(child.tour);
+            insert(island, std::move(child));
+        }
+        island.generations++;
+    }
+}
+
+/**
+ * @brief Order crossover (OX): copies a random slice of the first parent and fills the other positions with the
+ * remaining vertices in the order they appear in the second parent, starting after the slice
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+GeneticSearch::Individual GeneticSearch::crossover(Island &island, const Individual &a, const Individual &b) {
+    int lo = island.rng() % n, hi = island.rng() % n;
+    if (lo > hi)
+        std::swap(lo, hi);
+
+    Individual child{std::vector<int>(n), 0};
+    std::fill(island.taken.begin(), island.taken.end(), 0);
+    for (int i = lo; i <= hi; i++) {
+        child.tour[i] = a.tour[i];
+        island.taken[a.tour[i]] = 1;
+    }
+    int out = (hi + 1) % n;
+    for (int i = 0; i < n; i++) {
+        int v = b.tour[(hi + 1 + i) % n];
+        if (island.taken[v])
+            continue;
+        child.tour[out] = v;
+        out = (out + 1) % n;
+    }
+    return child;
+}
+
+/**
+ * @brief Local search step of a child: 2-opt over the candidate lists until no move improves it
+ */
+void GeneticSearch::localSearch(Individual &child) {
+    Management::improveTwoOptCandidates(cand, child.tour);
+}
+
+/**
+ * @brief Binary tournament
+ * @return index of the cheaper of two random members
+ */
+int GeneticSearch::select(Island &island) {
+    int a = island.rng() % island.population.size();
+    int b = island.rng() % island.population.size();
+    return island.population[a].cost < island.population[b].cost ? a : b;
+}
+
+/**
+ * @brief Replaces the worst member by the child if the child is cheaper and its cost is not in the population yet,
+ * which keeps copies of the same tour from taking over
+ */
+void GeneticSearch::insert(Island &island, Individual &&child) {
+    auto worst = island.population.begin();
+    for (auto it = island.population.begin(); it != island.population.end(); it++) {
+        if (std::abs(it->cost - child.cost) < 1e-7)
+            return;
+        if (it->cost > worst->cost)
+            worst = it;
+    }
+    if (child.cost < worst->cost)
+        *worst = std::move(child);
+}
+
+/**
+ * @brief Cost of a closed tour of vertex indices
+ */
+double GeneticSearch::cost(const std::vector<int> &tour) const {
+    double total = 0;
+    for (size_t i = 0; i < tour.size(); i++)
+        total += cand.dist(tour[i], tour[(i + 1) % tour.size()]);
+    return total;
+}
+
+/**
+ * @brief Turns a tour of vertex infos into vertex indices
+ * @return the indices, empty if the tour does not visit every vertex of the graph exactly once
+ */
+std::vector<int> GeneticSearch::toIndices(const std::vector<int> &infos) const {
+    if ((int) infos.size() != n)
+        return {};
+    std::vector<int> index(n);
+    std::unordered_map<int, int> byInfo;
+    for (int i = 0; i < n; i++)
+        byInfo[cand.getInfo(i)] = i;
+    std::vector<bool> seen(n, false);
+    for (int i = 0; i < n; i++) {
+        auto it = byInfo.find(infos[i]);
+        if (it == byInfo.end() || seen[it->second])
+            return {};
+        seen[it->second] = true;
+        index[i] = it->second;
+    }
+    return index;
+}
+
+/**
+ * @brief Best tour found by the last run
+ * @return vertex infos of the tour, starting at node 0 of the dataset, empty if run was not called
+ */
+std::vector<int> GeneticSearch::getBestTour() const {
+    std::vector<int> tour;
+    for (int idx : best.tour)
+        tour.push_back(cand.getInfo(idx));
+    auto first = std::find(tour.begin(), tour.end(), graph->getInternalId(0));
+    if (first != tour.end())
+        std::rotate(tour.begin(), first, tour.end());
+    return tour;
+}
+
+/**
+ * @brief Generations run by all islands together in the last run
+ */
+long GeneticSearch::getGenerations() const {
+    return generations;
+}
+
+/**
+ * @brief Throughput of the last run: generations of all islands per second, divided by the threads that ran them
+ */
+double GeneticSearch::getGenerationsPerSecondPerCore() const {
+    if (elapsedSeconds <= 0)
+        return 0;
+    return generations / elapsedSeconds / std::min<int>(cores, std::max<size_t>(islands.size(), 1));
+}
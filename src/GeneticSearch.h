@@ -0,0 +1,87 @@
+#ifndef PROJECT2_GENETICSEARCH_H
+#define PROJECT2_GENETICSEARCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "Candidates.h"
+
+class Graph;
+
+/**
+ * @brief Parameters of the genetic algorithm
+ */
+struct GeneticOptions {
+    // number of islands, 0 for one per thread of the pool
+    int islands = 0;
+    int populationSize = 24;
+    // generations between migrations of the best tour of each island to the next one
+    int migrationInterval = 10;
+    // chance of a random segment reversal before the local search of a child
+    double mutationRate = 0.2;
+    long timeLimitMs = 10000;
+    // flag set by another thread to end the search before the time limit, such as a rival solver proving optimality;
+    // ignored if null
+    const std::atomic<bool> *stop = nullptr;
+    uint32_t seed = 1;
+    // tour of vertex infos added to the seed tours, such as a result found earlier; ignored if empty
+    std::vector<int> initialTour;
+};
+
+/**
+ * @brief Island model genetic algorithm: every island evolves its own population on a thread of the pool, with order
+ * crossover, a mutation and a 2-opt local search over the candidate lists on every child, and the islands exchange
+ * their best tours at regular intervals. The populations are seeded with the nearest neighbour and triangular
+ * approximation tours.
+ */
+class GeneticSearch {
+public:
+    GeneticSearch(Graph *graph, const GeneticOptions &options);
+
+    double run();
+    std::vector<int> getBestTour() const;
+    long getGenerations() const;
+    double getGenerationsPerSecondPerCore() const;
+
+private:
+    /**
+     * @brief Tour of vertex indices and its cost
+     */
+    struct Individual {
+        std::vector<int> tour;
+        double cost;
+    };
+
+    /**
+     * @brief Population of one island with its own random generator and scratch buffers
+     */
+    struct Island {
+        std::vector<Individual> population;
+        std::mt19937 rng;
+        long generations = 0;
+        std::vector<char> taken;
+    };
+
+    void evolve(Island &island, int generations);
+    Individual crossover(Island &island, const Individual &a, const Individual &b);
+    void localSearch(Individual &child);
+    int select(Island &island);
+    void insert(Island &island, Individual &&child);
+    double cost(const std::vector<int> &tour) const;
+    std::vector<int> toIndices(const std::vector<int> &infos) const;
+
+    Graph *graph;
+    GeneticOptions options;
+    CandidateLists cand;
+    int n;
+
+    std::vector<Island> islands;
+    Individual best;
+    long generations = 0;
+    double elapsedSeconds = 0;
+    int cores = 1;
+};
+
+#endif //PROJECT2_GENETICSEARCH_H
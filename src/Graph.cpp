@@ -1,75 +1,419 @@
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 #include "Graph.h"
+#include "Auxiliar.h"
+#include "Management.h"
 
+namespace {
+
+/**
+ * @brief TSPLIB's DDD.MM to radians, with its value of pi so the distances match the published optima
+ */
+double geoRadians(double x) {
+    const double PI = 3.141592;
+    double deg = (int) x;
+    return PI * (deg + 5.0 * (x - deg) / 3.0) / 180.0;
+}
+
+}
+
+
+/**
+ * @brief Destructor, frees every vertex, edge and the distance matrix
+ * @details Time Complexity O(v + e) -> v: number of vertices, e: number of edges
+ */
+Graph::~Graph() {
+    for (Vertex *v : vertexSet) {
+        for (Edge *e : v->getAdj())
+            delete e;
+        delete v;
+    }
+    if (distMatrix != nullptr) {
+        for (int i = 0; i < matrixSize; i++)
+            delete[] distMatrix[i];
+        delete[] distMatrix;
+    }
+    delete[] tiles;
+}
 
 int Graph::getNumVertex() const {
     return vertexSet.size();
 }
 
-std::vector<Vertex *> Graph::getVertexSet() const {
+/**
+ * @brief Vertex set, as a view into the graph (no copy). Invalidated when vertices are added or removed.
+ */
+std::span<Vertex *const> Graph::getVertexSet() const {
     return vertexSet;
 }
 
 /**
  * @brief Auxiliary function to find a vertex with a given content
  * @return v if dound
- * @details Time Complexity O(n) = number of vertices
+ * @details Time Complexity O(1) on average
  */
 Vertex * Graph::findVertex(const int &in) const {
-    for (auto v : vertexSet)
-        if (v->getInfo() == in)
-            return v;
-    return nullptr;
+    auto it = positions.find(in);
+    return it == positions.end() ? nullptr : vertexSet[it->second];
 }
 
 /**
  * @brief Finds the index of the vertex with a given content
- * @return i if found
- * @details Time Complexity O(n) = number of vertices
+ * @return i if found, -1 otherwise
+ * @details Time Complexity O(1) on average
  */
 int Graph::findVertexIdx(const int &in) const {
-    for (unsigned i = 0; i < vertexSet.size(); i++)
-        if (vertexSet[i]->getInfo() == in)
-            return i;
-    return -1;
+    auto it = positions.find(in);
+    return it == positions.end() ? -1 : it->second;
 }
 
 /**
  * @brief Adds a vertex with a given content or info (in) to a graph (this).
  * @return true if added
- * @details Time Complexity O(n) = number of vertices
+ * @details Time Complexity O(1) on average
  */
 bool Graph::addVertex(const int &in, const double lat, const double lng) {
-    if (findVertex(in) != nullptr)
+    if (!positions.emplace(in, vertexSet.size()).second)
         return false;
     vertexSet.push_back(new Vertex(in, lat, lng));
     return true;
 }
 
+/**
+ * @brief Adds a vertex once the graph is loaded: its dataset id gets the next info when the vertices were renumbered,
+ * or when the id is past the rows of the matrix, and the distance matrix grows, or the coordinates are stored, so its distances can be set or computed.
+ * The distances from it to the other vertices are left at 0 in the matrix.
+ * @param original id of the vertex in the dataset
+ * @param lon longitude, or x coordinate
+ * @param lat latitude, or y coordinate
+ * @return info of the new vertex, -1 if the id is already a vertex of the graph
+ * @throws std::runtime_error if the grown matrix does not fit in the memory limit
+ * @details Time Complexity O(1) amortised, O(v²) when the matrix grows -> v: number of vertices
+ */
+int Graph::insertVertex(int original, double lon, double lat) {
+    int in = getInternalId(original);
+    if (in >= 0 && findVertex(in) != nullptr)
+        return -1;
+    int rows = metric == Metric::Matrix ? matrixSize : (int) coordX.size();
+    bool mapped = !originalIds.empty();
+    if (!mapped && original >= rows) {
+        // an id past the matrix starts an id map, so the infos stay dense instead of the matrix growing to the id
+        std::vector<int> ids(rows);
+        std::iota(ids.begin(), ids.end(), 0);
+        setOriginalIds(ids);
+        mapped = true;
+        in = -1;
+    }
+    if (mapped && in < 0) {
+        in = originalIds.size();
+        originalIds.push_back(original);
+        if (original >= (int) internalIds.size())
+            internalIds.resize(original + 1, -1);
+        internalIds[original] = in;
+    }
+    if (in < 0)
+        return -1;
+
+    if (metric == Metric::Matrix) {
+        if (in >= matrixSize) {
+            growMatrix(std::max(in + 1, matrixSize + matrixSize / 2));
+        } else {
+            // the info of a removed vertex is taken again, its old distances are cleared
+            for (int j = 0; j < matrixSize; j++)
+                addToDistMatrix(in, j, 0);
+        }
+    } else {
+        if (in >= (int) coordX.size()) {
+            coordX.resize(in + 1, 0);
+            coordY.resize(in + 1, 0);
+        }
+        // GEO keeps the latitude as x, in radians
+        if (metric == Metric::Geo) {
+            coordX[in] = geoRadians(lat);
+            coordY[in] = geoRadians(lon);
+        } else {
+            coordX[in] = lon;
+            coordY[in] = lat;
+        }
+    }
+    addVertex(in, lon, lat);
+    return in;
+}
+
+/**
+ * @brief Queues a vertex to add, with the coordinates the haversine distances to the other vertices are taken from
+ * @param original id of the vertex in the dataset
+ */
+void GraphBatch::addVertex(int original, double lon, double lat) {
+    addedVertices.push_back({original, lon, lat});
+}
+
+/**
+ * @brief Queues a vertex to remove, with all its edges
+ * @param original id of the vertex in the dataset
+ */
+void GraphBatch::removeVertex(int original) {
+    removedVertices.push_back(original);
+}
+
+/**
+ * @brief Queues an edge to add both ways, which also sets the distance between its ends; its ends may be vertices
+ * added by the same batch
+ */
+void GraphBatch::addEdge(int v1, int v2, double w) {
+    addedEdges.push_back({v1, v2, w});
+}
+
+/**
+ * @brief Queues the edges between two vertices to remove, both ways
+ */
+void GraphBatch::removeEdge(int v1, int v2) {
+    removedEdges.emplace_back(v1, v2);
+}
+
+bool GraphBatch::empty() const {
+    return addedVertices.empty() && removedVertices.empty() && addedEdges.empty() && removedEdges.empty();
+}
+
+/**
+ * @brief Makes room for n vertices, so adding them does not reallocate
+ * @param n number of vertices
+ */
+void Graph::reserve(int n) {
+    vertexSet.reserve(n);
+    positions.reserve(n);
+}
 
 /**
  * @brief  Removes a vertex with a given content (in) from a graph (this), and all outgoing and incoming edges.
+ * Only the edge lists of its neighbours are touched, and only the vertices after it change position.
  * @param in
  * @return true if removed
- * @details Time Complexity O(n) = number of vertices
+ * @details Time Complexity O(v + s) -> v: number of vertices, s: sum of the degrees of its neighbours
  */
 bool Graph::removeVertex(const int &in) {
-    for (auto it = vertexSet.begin(); it != vertexSet.end(); it++) {
-        if ((*it)->getInfo() == in) {
-            auto v = *it;
-            v->removeOutgoingEdges();
-            for (auto u : vertexSet) {
-                u->removeEdge(v->getInfo());
+    int p = findVertexIdx(in);
+    if (p < 0)
+        return false;
+    Vertex *v = vertexSet[p];
+    std::vector<Edge *> dead;
+    for (auto edges : {v->getAdj(), v->getIncoming()}) {
+        for (Edge *e : edges) {
+            if (!e->isRemoved()) {
+                e->setRemoved(true);
+                dead.push_back(e);
+            }
+        }
+    }
+    dropEdges(dead);
+    vertexSet.erase(vertexSet.begin() + p);
+    delete v;
+    // the vertices after it moved down by one
+    positions.erase(in);
+    for (unsigned i = p; i < vertexSet.size(); i++)
+        positions[vertexSet[i]->getInfo()] = i;
+    return true;
+}
+
+/**
+ * @brief Applies a batch of changes in one pass: the removed edges and the edges of the removed vertices are marked
+ * (tombstones), every vertex they touch drops its marked edges with a single scan of its lists, the vertex set and the
+ * positions are rebuilt once, and then the new vertices and edges are added.
+ * When the rows of the removed vertices outnumber the live ones, the graph is compacted: the vertices are renumbered
+ * 0..v-1 and the distance matrix, or the coordinates, and the id map shrink to match.
+ * The distance matrix stays consistent: a removed edge leaves the haversine distance between its ends, as loading does
+ * for a pair without an edge, and a new vertex gets the haversine distance to every vertex it has no edge to. On a
+ * graph without coordinates (see hasCoordinates) a removed edge keeps its distance, and a new vertex gets the shortest
+ * way to each vertex through its own edges instead (see Auxiliar::completeVertex).
+ * Ids that are not vertices of the graph, and vertices that already exist, are skipped.
+ * @param batch changes, named by the ids of the dataset
+ * @return infos of the removed and added vertices, and the renumbering if the graph was compacted
+ * @throws std::runtime_error if a grown or compacted matrix does not fit in the memory limit
+ * @details Time Complexity O(v + s + a v) plus O(v²) for a compaction, which runs at most once every v removals
+ * -> v: number of vertices, s: sum of the degrees of the vertices touched, a: vertices added
+ */
+BatchResult Graph::apply(const GraphBatch &batch) {
+    BatchResult result;
+    // without coordinates there is no distance to fall back on, so cut edges keep theirs
+    bool coordinates = hasCoordinates();
+    std::vector<Edge *> dead;
+    auto bury = [&dead](Edge *e) {
+        if (!e->isRemoved()) {
+            e->setRemoved(true);
+            dead.push_back(e);
+        }
+    };
+
+    for (auto [o1, o2] : batch.removedEdges) {
+        Vertex *v1 = findVertex(getInternalId(o1)), *v2 = findVertex(getInternalId(o2));
+        if (v1 == nullptr || v2 == nullptr)
+            continue;
+        size_t before = dead.size();
+        for (auto [from, to] : {std::pair(v1, v2), std::pair(v2, v1)}) {
+            for (Edge *e : from->getAdj()) {
+                if (e->getDest() == to)
+                    bury(e);
+            }
+        }
+        if (dead.size() > before && coordinates)
+            addToDistMatrix(v1->getInfo(), v2->getInfo(), Management::getHaversineDist(v1, v2));
+    }
+
+    std::vector<char> gone(vertexSet.size(), 0);
+    for (int original : batch.removedVertices) {
+        int p = findVertexIdx(getInternalId(original));
+        if (p < 0 || gone[p])
+            continue;
+        gone[p] = 1;
+        result.removed.push_back(vertexSet[p]->getInfo());
+        for (auto edges : {vertexSet[p]->getAdj(), vertexSet[p]->getIncoming()}) {
+            for (Edge *e : edges)
+                bury(e);
+        }
+    }
+    dropEdges(dead);
+
+    if (!result.removed.empty()) {
+        size_t kept = 0;
+        for (size_t p = 0; p < vertexSet.size(); p++) {
+            if (gone[p]) {
+                positions.erase(vertexSet[p]->getInfo());
+                delete vertexSet[p];
+            } else {
+                vertexSet[kept++] = vertexSet[p];
             }
-            vertexSet.erase(it);
-            delete v;
-            return true;
         }
+        vertexSet.resize(kept);
+        for (size_t p = 0; p < kept; p++)
+            positions[vertexSet[p]->getInfo()] = p;
+        result.renumbered = compact();
+    }
+
+    for (const auto &v : batch.addedVertices) {
+        int in = insertVertex(v.original, v.lon, v.lat);
+        if (in >= 0)
+            result.added.push_back(in);
+    }
+    for (const auto &e : batch.addedEdges) {
+        int in1 = getInternalId(e.v1), in2 = getInternalId(e.v2);
+        if (findVertex(in1) == nullptr || findVertex(in2) == nullptr)
+            continue;
+        addBidirectionalEdge(in1, in2, e.w);
+        addToDistMatrix(in1, in2, e.w);
+    }
+    for (int in : result.added)
+        Auxiliar::completeVertex(this, in, coordinates);
+    return result;
+}
+
+/**
+ * @brief Whether the vertices have coordinates the distances can be computed from: always for the coordinate metrics,
+ * otherwise if any vertex was given a position. The toy and medium datasets leave every vertex at (0, 0).
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+bool Graph::hasCoordinates() const {
+    if (metric != Metric::Matrix)
+        return true;
+    for (Vertex *v : vertexSet) {
+        if (v->getLat() != 0 || v->getLon() != 0)
+            return true;
     }
     return false;
 }
 
+/**
+ * @brief Drops edges marked as removed from the lists of the vertices they touch, each list scanned once, clears the
+ * reverse of the edges that stay, and deletes them
+ * @param dead edges marked as removed, each once
+ * @details Time Complexity O(k log k + s) -> k: number of edges, s: sum of the degrees of the vertices they touch
+ */
+void Graph::dropEdges(const std::vector<Edge *> &dead) {
+    std::vector<Vertex *> touched;
+    touched.reserve(2 * dead.size());
+    for (Edge *e : dead) {
+        touched.push_back(e->getOrig());
+        touched.push_back(e->getDest());
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (Vertex *v : touched)
+        v->dropRemovedEdges();
+    for (Edge *e : dead) {
+        Edge *reverse = e->getReverse();
+        if (reverse != nullptr && !reverse->isRemoved())
+            reverse->setReverse(nullptr);
+    }
+    for (Edge *e : dead)
+        delete e;
+}
+
+/**
+ * @brief Renumbers the vertices 0..v-1, keeping the order of their infos, once the rows left by removed vertices
+ * outnumber the live ones, and shrinks the distance matrix (keeping its layout), or the coordinates, and the id map
+ * @return new info of every old info, -1 for the removed ones; empty if the graph was not compacted
+ * @throws std::runtime_error if the compacted matrix does not fit in the memory limit
+ * @details Time Complexity O(v²) for a matrix, O(v log v) for coordinates -> v: number of vertices
+ */
+std::vector<int> Graph::compact() {
+    int n = vertexSet.size();
+    int rows = metric == Metric::Matrix ? matrixSize : (int) coordX.size();
+    if (rows - n <= n)
+        return {};
+
+    std::vector<int> infos;
+    infos.reserve(n);
+    for (Vertex *v : vertexSet)
+        infos.push_back(v->getInfo());
+    std::sort(infos.begin(), infos.end());
+    std::vector<int> renumbered(std::max(rows, n > 0 ? infos.back() + 1 : 0), -1);
+    for (int k = 0; k < n; k++)
+        renumbered[infos[k]] = k;
+
+    if (metric == Metric::Matrix) {
+        Memory::checkFits("distance matrix of " + std::to_string(n) + " vertices",
+                          (size_t) n * (n * sizeof(double) + sizeof(double *)));
+        bool tiled = tiles != nullptr;
+        auto matrix = new double*[n];
+        for (int i = 0; i < n; i++) {
+            matrix[i] = new double[n];
+            for (int j = 0; j < n; j++)
+                matrix[i][j] = getDist(infos[i], infos[j]);
+        }
+        if (tiled) {
+            delete[] tiles;
+            tiles = nullptr;
+        } else {
+            for (int i = 0; i < matrixSize; i++)
+                delete[] distMatrix[i];
+            delete[] distMatrix;
+        }
+        distMatrix = matrix;
+        matrixSize = n;
+        if (tiled)
+            useTiledLayout();
+    } else {
+        std::vector<double> xs(n), ys(n);
+        for (int k = 0; k < n; k++) {
+            xs[k] = coordX[infos[k]];
+            ys[k] = coordY[infos[k]];
+        }
+        coordX = std::move(xs);
+        coordY = std::move(ys);
+    }
+
+    std::vector<int> ids(n);
+    for (int k = 0; k < n; k++)
+        ids[k] = getOriginalId(infos[k]);
+    positions.clear();
+    for (int p = 0; p < n; p++) {
+        vertexSet[p]->setInfo(renumbered[vertexSet[p]->getInfo()]);
+        positions[vertexSet[p]->getInfo()] = p;
+    }
+    setOriginalIds(ids);
+    return renumbered;
+}
 
 /**
  * @brief Adds an edge to a graph (this), given the contents of the source and destination vertices and the edge weight (w)
@@ -77,7 +421,7 @@ bool Graph::removeVertex(const int &in) {
  * @param dest
  * @param w
  * @return true if successful
- * @details Time Complexity O(n) = number of vertices
+ * @details Time Complexity O(1) on average
  *
  */
 bool Graph::addEdge(const int &sourc, const int &dest, double w) {
@@ -94,7 +438,7 @@ bool Graph::addEdge(const int &sourc, const int &dest, double w) {
  * @param sourc
  * @param dest
  * @return true if successful
- * @details Time Complexity O(n) = number of vertices
+ * @details Time Complexity O(1) on average
  */
 bool Graph::removeEdge(const int &sourc, const int &dest) {
     Vertex * srcVertex = findVertex(sourc);
@@ -110,7 +454,7 @@ bool Graph::removeEdge(const int &sourc, const int &dest) {
  * @param dest
  * @param w
  * @return true if successful
- * @details Time Complexity O(n) = number of vertices
+ * @details Time Complexity O(1) on average
  */
 bool Graph::addBidirectionalEdge(const int &sourc, const int &dest, double w) {
     auto v1 = findVertex(sourc);
@@ -125,14 +469,285 @@ bool Graph::addBidirectionalEdge(const int &sourc, const int &dest, double w) {
 }
 
 void Graph::addToDistMatrix(int v1, int v2, double dist) {
+    if (metric != Metric::Matrix)
+        return;
+    if (tiles != nullptr) {
+        tiles[tileIndex(v1, v2)] = dist;
+        tiles[tileIndex(v2, v1)] = dist;
+        return;
+    }
     this->distMatrix[v1][v2] = dist;
     this->distMatrix[v2][v1] = dist;
 }
 
+/**
+ * @brief Changes the distance between two vertices in the matrix, and the weight of the edges between them if any
+ * @return false if the distances are computed from coordinates, so they can not be changed
+ * @details Time Complexity O(d) -> d: degree of the two vertices
+ */
+bool Graph::setWeight(int v1, int v2, double w) {
+    if (metric != Metric::Matrix)
+        return false;
+    addToDistMatrix(v1, v2, w);
+    for (int k = 0; k < 2; k++) {
+        Vertex *v = findVertex(k ? v2 : v1);
+        int other = k ? v1 : v2;
+        if (v == nullptr)
+            continue;
+        for (Edge *e : v->getAdj()) {
+            if (e->getDest()->getInfo() == other)
+                e->setWeight(w);
+        }
+    }
+    return true;
+}
+
 double Graph::getDist(int v1, int v2) const {
+    if (metric != Metric::Matrix)
+        return implicitDist(v1, v2);
+    if (tiles != nullptr)
+        return tiles[tileIndex(v1, v2)];
     return this->distMatrix[v1][v2];
 }
 
-void Graph::setMatrix(double* newMatrix[]){
+/**
+ * @brief Position of an entry in the tiled layout: tiles are stored row by row, and so are the entries of each tile
+ */
+size_t Graph::tileIndex(int v1, int v2) const {
+    size_t tile = (size_t) (v1 >> TILE_SHIFT) * tilesPerRow + (v2 >> TILE_SHIFT);
+    return (tile << (2 * TILE_SHIFT)) + ((v1 & (TILE - 1)) << TILE_SHIFT) + (v2 & (TILE - 1));
+}
+
+/**
+ * @brief Converts the distance matrix to a blocked layout of TILE x TILE tiles.
+ * When the vertices are numbered along a space-filling curve, nearby vertices share tiles, so the row scans and
+ * neighbour lookups of the solvers stay within a few cache-resident blocks.
+ * @throws std::runtime_error if the tiled copy does not fit in the memory limit
+ * @details Time Complexity O(v²) -> v: number of vertices
+ */
+void Graph::useTiledLayout() {
+    if (tiles != nullptr || distMatrix == nullptr)
+        return;
+    tilesPerRow = (matrixSize + TILE - 1) / TILE;
+    size_t size = (size_t) tilesPerRow * tilesPerRow * TILE * TILE;
+    Memory::checkFits("tiled distance matrix", size * sizeof(double));
+
+    tiles = new double[size]();
+    for (int i = 0; i < matrixSize; i++) {
+        for (int j = 0; j < matrixSize; j++)
+            tiles[tileIndex(i, j)] = distMatrix[i][j];
+        delete[] distMatrix[i];
+    }
+    delete[] distMatrix;
+    distMatrix = nullptr;
+}
+
+/**
+ * @brief Grows the distance matrix, or its tiled layout, to n rows and columns, keeping the distances it holds
+ * @param n new number of rows, larger than the current one
+ * @throws std::runtime_error if the grown matrix does not fit in the memory limit
+ * @details Time Complexity O(n²)
+ */
+void Graph::growMatrix(int n) {
+    if (tiles != nullptr) {
+        int newPerRow = (n + TILE - 1) / TILE;
+        if (newPerRow > tilesPerRow) {
+            size_t size = (size_t) newPerRow * newPerRow * TILE * TILE;
+            Memory::checkFits("tiled distance matrix", size * sizeof(double));
+            auto *grown = new double[size]();
+            // tiles are contiguous, so each is copied whole to its place in the wider grid
+            size_t block = (size_t) TILE * TILE;
+            for (int r = 0; r < tilesPerRow; r++) {
+                for (int c = 0; c < tilesPerRow; c++)
+                    std::copy_n(tiles + ((size_t) r * tilesPerRow + c) * block, block,
+                                grown + ((size_t) r * newPerRow + c) * block);
+            }
+            delete[] tiles;
+            tiles = grown;
+            tilesPerRow = newPerRow;
+        }
+        matrixSize = n;
+        return;
+    }
+    Memory::checkFits("distance matrix of " + std::to_string(n) + " vertices",
+                      (size_t) n * (n * sizeof(double) + sizeof(double *)));
+    auto grown = new double*[n];
+    for (int i = 0; i < n; i++) {
+        grown[i] = new double[n]();
+        if (i < matrixSize) {
+            std::copy_n(distMatrix[i], matrixSize, grown[i]);
+            delete[] distMatrix[i];
+        }
+    }
+    delete[] distMatrix;
+    distMatrix = grown;
+    matrixSize = n;
+}
+
+bool Graph::isTiled() const {
+    return tiles != nullptr;
+}
+
+/**
+ * @brief Switches the graph to distances computed from coordinates on access, so no matrix is stored
+ * @param newMetric how the distance is computed from the coordinates
+ * @param xs x coordinate of each vertex, indexed by vertex info
+ * @param ys y coordinate of each vertex, indexed by vertex info
+ * @details GEO coordinates are converted to radians once here instead of on every access.
+ */
+void Graph::setCoordinates(Metric newMetric, const std::vector<double> &xs, const std::vector<double> &ys) {
+    metric = newMetric;
+    coordX = xs;
+    coordY = ys;
+    if (metric == Metric::Geo) {
+        for (double &x : coordX)
+            x = geoRadians(x);
+        for (double &y : coordY)
+            y = geoRadians(y);
+    }
+}
+
+Metric Graph::getMetric() const {
+    return metric;
+}
+
+/**
+ * @brief Distance computed from the coordinates, following the TSPLIB definitions
+ * @details Time Complexity O(1)
+ */
+double Graph::implicitDist(int v1, int v2) const {
+    double dx = coordX[v1] - coordX[v2];
+    double dy = coordY[v1] - coordY[v2];
+    switch (metric) {
+        case Metric::Euclidean:
+            return (int) (std::sqrt(dx * dx + dy * dy) + 0.5);
+        case Metric::Att: {
+            double r = std::sqrt((dx * dx + dy * dy) / 10.0);
+            int t = (int) (r + 0.5);
+            return t < r ? t + 1 : t;
+        }
+        case Metric::Geo: {
+            if (v1 == v2)
+                return 0;
+            // x is the latitude and y the longitude
+            const double RRR = 6378.388;
+            double q1 = std::cos(coordY[v1] - coordY[v2]);
+            double q2 = std::cos(coordX[v1] - coordX[v2]);
+            double q3 = std::cos(coordX[v1] + coordX[v2]);
+            return (int) (RRR * std::acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Records the ids the vertices had in the dataset, when they were renumbered at load time
+ * @param ids ids[info] is the id in the dataset of the vertex with that info
+ */
+void Graph::setOriginalIds(const std::vector<int> &ids) {
+    originalIds = ids;
+    internalIds.clear();
+    for (int i = 0; i < (int) ids.size(); i++) {
+        if (ids[i] >= (int) internalIds.size())
+            internalIds.resize(ids[i] + 1, -1);
+        internalIds[ids[i]] = i;
+    }
+}
+
+/**
+ * @brief Id in the dataset of a vertex
+ * @param in info of the vertex
+ * @return id in the dataset, in itself if the vertices were not renumbered
+ */
+int Graph::getOriginalId(int in) const {
+    if (in < 0 || in >= (int) originalIds.size())
+        return in;
+    return originalIds[in];
+}
+
+/**
+ * @brief Info of the vertex that had a given id in the dataset
+ * @param original id in the dataset
+ * @return info of the vertex, original itself if the vertices were not renumbered
+ */
+int Graph::getInternalId(int original) const {
+    if (originalIds.empty())
+        return original;
+    if (original < 0 || original >= (int) internalIds.size())
+        return -1;
+    return internalIds[original];
+}
+
+/**
+ * @brief Maps a tour of vertex infos back to the ids of the dataset
+ * @param tour vertex infos
+ * @return the same tour with dataset ids
+ */
+std::vector<int> Graph::toOriginalIds(const std::vector<int> &tour) const {
+    std::vector<int> res;
+    res.reserve(tour.size());
+    for (int in : tour)
+        res.push_back(getOriginalId(in));
+    return res;
+}
+
+/**
+ * @brief Maps a tour of dataset ids to vertex infos, the reverse of toOriginalIds
+ * @param tour dataset ids
+ * @return the same tour with vertex infos, empty if an id is not a vertex of the graph
+ * @details Time Complexity O(n) -> n: length of the tour
+ */
+std::vector<int> Graph::toInternalIds(const std::vector<int> &tour) const {
+    std::vector<int> res;
+    res.reserve(tour.size());
+    for (int original : tour) {
+        int in = getInternalId(original);
+        if (findVertex(in) == nullptr)
+            return {};
+        res.push_back(in);
+    }
+    return res;
+}
+
+/**
+ * @brief Sets the distance matrix, the graph takes ownership of it
+ * @param newMatrix n x n matrix allocated by Auxiliar::initMatrix
+ * @param n number of rows of the matrix
+ */
+void Graph::setMatrix(double* newMatrix[], int n){
     this->distMatrix = newMatrix;
+    this->matrixSize = n;
+}
+
+/**
+ * @brief Counts the edges of the graph (each direction of a bidirectional edge counts once)
+ * @return number of edges
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+int Graph::getNumEdges() const {
+    int count = 0;
+    for (Vertex *v : vertexSet)
+        count += v->getAdj().size();
+    return count;
+}
+
+/**
+ * @brief Bytes held by the distance matrix, the vertices (including their edge and children lists) and the edges
+ * @return memory usage per component, scratch is left at 0
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+MemoryUsage Graph::getMemoryUsage() const {
+    MemoryUsage usage;
+    if (tiles != nullptr)
+        usage.matrix = (size_t) tilesPerRow * tilesPerRow * TILE * TILE * sizeof(double);
+    else
+        usage.matrix = (size_t) matrixSize * (matrixSize * sizeof(double) + sizeof(double *));
+    usage.matrix += (coordX.capacity() + coordY.capacity()) * sizeof(double);
+    usage.vertices = vertexSet.capacity() * sizeof(Vertex *);
+    for (Vertex *v : vertexSet) {
+        usage.vertices += v->getMemoryUsage();
+        usage.edges += v->getAdj().size() * sizeof(Edge);
+    }
+    return usage;
 }
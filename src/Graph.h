@@ -7,12 +7,68 @@
 #include <queue>
 #include <limits>
 #include <algorithm>
+#include <unordered_map>
 #include "Vertex.h"
+#include "Memory.h"
 
 class Edge;
 
 #define INF std::numeric_limits<double>::max()
 
+/**
+ * @brief How the distance between two vertices is obtained
+ */
+enum class Metric {
+    Matrix,     // stored in the distance matrix
+    Euclidean,  // TSPLIB EUC_2D: rounded Euclidean distance between the coordinates
+    Geo,        // TSPLIB GEO: great-circle distance in km between coordinates in DDD.MM format
+    Att         // TSPLIB ATT: pseudo-Euclidean distance, rounded up
+};
+
+/**
+ * @brief Vertex and edge changes applied to a graph in one pass by Graph::apply. Vertices are named by their ids in
+ * the dataset, and edges connect both ways.
+ */
+class GraphBatch {
+public:
+    void addVertex(int original, double lon = 0, double lat = 0);
+    void removeVertex(int original);
+    void addEdge(int v1, int v2, double w);
+    void removeEdge(int v1, int v2);
+    bool empty() const;
+
+private:
+    friend class Graph;
+
+    struct NewVertex {
+        int original;
+        double lon;
+        double lat;
+    };
+    struct NewEdge {
+        int v1;
+        int v2;
+        double w;
+    };
+
+    std::vector<NewVertex> addedVertices;
+    std::vector<int> removedVertices;
+    std::vector<NewEdge> addedEdges;
+    std::vector<std::pair<int, int>> removedEdges;
+};
+
+/**
+ * @brief What Graph::apply did, so whoever holds vertex infos can follow
+ */
+struct BatchResult {
+    // infos the removed vertices had, before any renumbering
+    std::vector<int> removed;
+    // infos of the added vertices, after any renumbering
+    std::vector<int> added;
+    // new info of every old info, -1 for the removed vertices; empty if the graph was not compacted
+    std::vector<int> renumbered;
+};
+
 /**
  * @brief Graph Class Definition
  */
@@ -30,6 +86,7 @@ public:
 
     bool addVertex(const int &in, const double lat=0, const double lng=0 );
     bool removeVertex(const int &in);
+    int insertVertex(int original, double lon, double lat);
 
     /*
      * Adds an edge to a graph (this), given the contents of the source and
@@ -38,15 +95,34 @@ public:
      */
     bool addEdge(const int &sourc, const int  &dest, double w);
     bool removeEdge(const int &source, const int &dest);
+    BatchResult apply(const GraphBatch &batch);
+    bool hasCoordinates() const;
     bool addBidirectionalEdge(const int &sourc, const int &dest, double w);
 
+    void reserve(int n);
     int getNumVertex() const;
-    std::vector<Vertex *> getVertexSet() const;
+    std::span<Vertex *const> getVertexSet() const;
 
     void addToDistMatrix(int v1, int v2, double dist);
-    void setMatrix(double* newMatrix[]);
+    bool setWeight(int v1, int v2, double w);
+    void setMatrix(double* newMatrix[], int n);
     double getDist(int v1, int v2) const;
 
+    void useTiledLayout();
+    bool isTiled() const;
+
+    void setCoordinates(Metric newMetric, const std::vector<double> &xs, const std::vector<double> &ys);
+    Metric getMetric() const;
+
+    void setOriginalIds(const std::vector<int> &ids);
+    int getOriginalId(int in) const;
+    int getInternalId(int original) const;
+    std::vector<int> toOriginalIds(const std::vector<int> &tour) const;
+    std::vector<int> toInternalIds(const std::vector<int> &tour) const;
+
+    MemoryUsage getMemoryUsage() const;
+    int getNumEdges() const;
+
     // Finds the index of the vertex with a given content.
     int findVertexIdx(const int &in) const;
 
@@ -54,7 +130,32 @@ protected:
     std::vector<Vertex *> vertexSet;    // vertex set
 
 
-    double** distMatrix;
+    double** distMatrix = nullptr;
+    int matrixSize = 0;                 // number of rows (and columns) of distMatrix
+
+    // blocked layout: TILE x TILE blocks stored contiguously, replaces distMatrix when set
+    static const int TILE_SHIFT = 6;
+    static const int TILE = 1 << TILE_SHIFT;
+    double *tiles = nullptr;
+    int tilesPerRow = 0;
+    size_t tileIndex(int v1, int v2) const;
+    void growMatrix(int n);
+
+    void dropEdges(const std::vector<Edge *> &dead);
+    std::vector<int> compact();
+
+    // ids read from the dataset when the vertices were renumbered at load time (empty if they were not)
+    std::vector<int> originalIds;
+    std::vector<int> internalIds;
+
+    // position in vertexSet of the vertex with each info
+    std::unordered_map<int, int> positions;
+
+    // implicit distances: coordinates indexed by vertex info, distances computed on access
+    Metric metric = Metric::Matrix;
+    std::vector<double> coordX;
+    std::vector<double> coordY;
+    double implicitDist(int v1, int v2) const;
 };
 
 #endif //PROJECT2_GRAPH_H
@@ -0,0 +1,53 @@
+#ifndef PROJECT2_LITTLEENDIAN_H
+#define PROJECT2_LITTLEENDIAN_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+/**
+ * @brief Binary encoding of the files the program writes for itself (result cache, checkpoints): integers and doubles
+ * are written byte by byte, least significant first, so the files read the same on any host
+ */
+namespace LittleEndian {
+
+/**
+ * @brief Writes an integer or a double
+ */
+template<typename T>
+void put(std::ostream &out, T value) {
+    uint64_t bits = 0;
+    if constexpr (std::is_floating_point_v<T>)
+        std::memcpy(&bits, &value, sizeof(value));
+    else
+        bits = (std::make_unsigned_t<T>) value;
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); i++)
+        bytes[i] = (char) (bits >> (8 * i));
+    out.write(bytes, sizeof(T));
+}
+
+/**
+ * @brief Reads an integer or a double written by put
+ * @return false if the stream ended first
+ */
+template<typename T>
+bool get(std::istream &in, T &value) {
+    unsigned char bytes[sizeof(T)];
+    if (!in.read(reinterpret_cast<char *>(bytes), sizeof(T)))
+        return false;
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(T); i++)
+        bits |= (uint64_t) bytes[i] << (8 * i);
+    if constexpr (std::is_floating_point_v<T>)
+        std::memcpy(&value, &bits, sizeof(value));
+    else
+        value = (T) (std::make_unsigned_t<T>) bits;
+    return true;
+}
+
+}
+
+#endif //PROJECT2_LITTLEENDIAN_H
@@ -0,0 +1,115 @@
+#include "LowerBound.h"
+#include "Graph.h"
+#include "Management.h"
+#include "Stats.h"
+#include "Trace.h"
+
+#include <chrono>
+#include <cmath>
+
+/**
+ * @brief Held-Karp bound: the best minimum 1-tree (a spanning tree of every vertex but one, plus the two cheapest
+ * edges of that one) over vertex penalties pi, found by subgradient optimisation.
+ * Every tour is a 1-tree, and adding pi[i] + pi[j] to each edge adds 2 * sum(pi) to every tour, so the 1-tree cost
+ * minus 2 * sum(pi) never exceeds the optimal tour. Each iteration moves pi along the degrees minus 2, which pushes
+ * the 1-tree towards a tour, with Polyak steps lambda * (upperBound - bound) / |degrees - 2|².
+ * @param graph graph with a complete symmetric distance matrix
+ * @param upperBound cost of a known tour, sets the step size and stops the search if the bound reaches it
+ * @param timeLimitMs time after which the best bound so far is returned, also checked within each 1-tree
+ * @param maxIterations maximum number of 1-trees computed
+ * @return the lower bound, 0 if the graph has less than 3 vertices or the first 1-tree did not fit in the time limit
+ * @details lambda starts at 2 and is halved after 10 iterations without improvement.
+ * Time Complexity O(i v² / t) -> i: iterations, v: number of vertices, t: number of threads
+ */
+double LowerBound::heldKarp(Graph *graph, double upperBound, long timeLimitMs, int maxIterations) {
+    STATS_TIMER(Phase::LowerBound);
+    TRACE_SPAN("heldKarp", "solve");
+    auto vertices = graph->getVertexSet();
+    int n = vertices.size();
+    if (n < 3)
+        return 0;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimitMs);
+    auto dist = [&](int i, int j) { return graph->getDist(vertices[i]->getInfo(), vertices[j]->getInfo()); };
+
+    // vertex 0 is the one left out of the spanning tree
+    const int special = 0;
+    std::vector<double> pi(n, 0);
+    std::vector<int> degree(n);
+    double best = 0;
+    double lambda = 2;
+    int stalled = 0;
+
+    for (int it = 0; it < maxIterations && std::chrono::steady_clock::now() < deadline; it++) {
+        STATS_INC(Counter::SubgradientIterations);
+        std::vector<int> parent = Management::primParents(graph, 1, &pi, special, deadline);
+        if (parent.empty())
+            break;
+
+        std::fill(degree.begin(), degree.end(), 0);
+        double cost = 0;
+        for (int v = 0; v < n; v++) {
+            if (parent[v] < 0)
+                continue;
+            cost += dist(v, parent[v]) + pi[v] + pi[parent[v]];
+            degree[v]++;
+            degree[parent[v]]++;
+        }
+
+        // the two cheapest edges of the special vertex close the 1-tree
+        int first = -1, second = -1;
+        double w1 = INF, w2 = INF;
+        for (int v = 1; v < n; v++) {
+            double w = dist(special, v) + pi[special] + pi[v];
+            if (w < w1) {
+                second = first;
+                w2 = w1;
+                first = v;
+                w1 = w;
+            } else if (w < w2) {
+                second = v;
+                w2 = w;
+            }
+        }
+        cost += w1 + w2;
+        degree[special] = 2;
+        degree[first]++;
+        degree[second]++;
+
+        double sumPi = 0;
+        for (double p : pi)
+            sumPi += p;
+        double bound = cost - 2 * sumPi;
+
+        if (bound > best + 1e-9) {
+            best = bound;
+            stalled = 0;
+        } else if (++stalled == 10) {
+            lambda /= 2;
+            stalled = 0;
+        }
+
+        double norm = 0;
+        for (int d : degree)
+            norm += (double) (d - 2) * (d - 2);
+        // a 1-tree where every degree is 2 is a tour, and an optimal one
+        if (norm == 0 || best >= upperBound - 1e-9 || lambda < 1e-6)
+            break;
+
+        double step = lambda * (upperBound - bound) / norm;
+        for (int v = 0; v < n; v++)
+            pi[v] += step * (degree[v] - 2);
+    }
+
+    return std::min(best, upperBound);
+}
+
+/**
+ * @brief Relative distance of a tour cost above a lower bound
+ * @return percentage, -1 if the bound is not positive
+ */
+double LowerBound::gap(double cost, double bound) {
+    if (bound <= 0)
+        return -1;
+    return (cost - bound) / bound * 100;
+}
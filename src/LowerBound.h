@@ -0,0 +1,15 @@
+#ifndef PROJECT2_LOWERBOUND_H
+#define PROJECT2_LOWERBOUND_H
+
+class Graph;
+
+/**
+ * @brief Lower bounds on the cost of the optimal tour, to tell how far a heuristic tour can be from it
+ */
+class LowerBound {
+public:
+    static double heldKarp(Graph *graph, double upperBound, long timeLimitMs, int maxIterations = 1000);
+    static double gap(double cost, double bound);
+};
+
+#endif //PROJECT2_LOWERBOUND_H
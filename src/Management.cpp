@@ -1,6 +1,114 @@
 #include "Management.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "TinySolver.h"
+#include "ExactSearch.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <deque>
 #include <limits>
+#include <numeric>
+#include <unordered_map>
+
+std::string Management::checkpointFile;
+long Management::checkpointIntervalMs = 60000;
+
+namespace {
+    /**
+     * @brief Disjoint sets of vertex indices, with path halving and union by size
+     */
+    struct UnionFind {
+        std::vector<int> parent;
+        std::vector<int> size;
+
+        explicit UnionFind(int n) : parent(n), size(n, 1) {
+            std::iota(parent.begin(), parent.end(), 0);
+        }
+
+        int find(int v) {
+            while (parent[v] != v) {
+                parent[v] = parent[parent[v]];
+                v = parent[v];
+            }
+            return v;
+        }
+
+        bool unite(int a, int b) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return false;
+            if (size[a] < size[b])
+                std::swap(a, b);
+            parent[b] = a;
+            size[a] += size[b];
+            return true;
+        }
+    };
+
+    /**
+     * @brief Candidate edge between two vertex indices, ordered by value and then by the indices
+     */
+    struct CandidateEdge {
+        double value;
+        int a;
+        int b;
+
+        bool operator<(const CandidateEdge &other) const {
+            if (value != other.value)
+                return value < other.value;
+            return a != other.a ? a < other.a : b < other.b;
+        }
+    };
+
+    /**
+     * @brief Collects every pair {v, w} where w is among the nearest neighbours of v, once, and scores it
+     * @param cand candidate lists
+     * @param skip vertex whose pairs are left out, -1 to keep all of them
+     * @param score value of the pair (v, w)
+     */
+    template<typename F>
+    std::vector<CandidateEdge> candidateEdges(const CandidateLists &cand, int skip, F score) {
+        std::vector<CandidateEdge> edges;
+        edges.reserve((size_t) cand.size() * cand.getK());
+        for (int v = 0; v < cand.size(); v++) {
+            if (v == skip)
+                continue;
+            for (int w : cand.of(v)) {
+                if (w == skip)
+                    continue;
+                // keep (v, w) from v's list, and from w's list only if v is not in it
+                auto other = cand.of(w);
+                if (v < w || std::find(other.begin(), other.end(), v) == other.end())
+                    edges.push_back({score(v, w), std::min(v, w), std::max(v, w)});
+            }
+        }
+        return edges;
+    }
+
+    /**
+     * @brief Accepts the sorted candidate edges that keep every degree at most 2 and close no cycle
+     * @return links of each vertex, -1 where there is none
+     */
+    std::vector<std::array<int, 2>> matchEdges(int n, const std::vector<CandidateEdge> &edges) {
+        std::vector<std::array<int, 2>> links(n, {-1, -1});
+        std::vector<int> degree(n, 0);
+        UnionFind sets(n);
+        int accepted = 0;
+        for (const CandidateEdge &e : edges) {
+            if (accepted == n - 1)
+                break;
+            if (degree[e.a] == 2 || degree[e.b] == 2 || !sets.unite(e.a, e.b))
+                continue;
+            links[e.a][degree[e.a]++] = e.b;
+            links[e.b][degree[e.b]++] = e.a;
+            accepted++;
+        }
+        return links;
+    }
+}
 
 /**
  * @brief Converts angle value to radians
@@ -19,6 +127,7 @@ double Management::convert(const double angle) {
  * @return haversine distance between v1 and v2
  */
 double Management::getHaversineDist(Vertex *v1, Vertex *v2) {
+    STATS_INC(Counter::HaversineCalls);
     const double earths_radius = 6371000;
 
     // Get the difference between our two points then convert the difference into radians
@@ -37,81 +146,99 @@ double Management::getHaversineDist(Vertex *v1, Vertex *v2) {
 
 
 /**
- * @brief Initializes values for the algorithm
+ * @brief Exact TSP following only the edges of the graph, starting and ending at the first vertex of the vertex set
  * @param graph
- * @return
+ * @param timeLimitMs time after which the search stops with the best tour so far, 0 for none
+ * @param complete if not null, set to whether the whole tree was searched, so the cost is the optimal one
+ * @return Cost of the optimal tour, INF if there is none
+ * @details Graphs of up to TinySolver::MAX_N vertices are dispatched to the compile-time specialised exact solver,
+ * bigger ones run the iterative branch and bound of ExactSearch.
+ * Time Complexity O(v!) -> v: number of vertices
  */
-double Management::tspBacktracking(Graph *graph){
+double Management::tspBacktracking(Graph *graph, long timeLimitMs, bool *complete){
+    STATS_TIMER(Phase::Search);
+    TRACE_SPAN("tspBacktracking", "solve");
+    if (complete != nullptr)
+        *complete = true;
     int n = graph->getVertexSet().size();
-    double ans = INF;
-    graph->getVertexSet()[0]->setVisited(true);
-    tspBacktrackingAlgorithm(graph,0,n,1,0,ans);
-    return ans;
+    if (n >= 2 && n <= TinySolver::MAX_N)
+        return TinySolver::solve(graph);
+
+    return exactSearch(graph, 0, timeLimitMs, complete);
 }
 
 /**
- * @brief TSP Backtracking Algorithm
- * @param graph - current graph
- * @param currIdx - current index
- * @param n - number of vertices
- * @param count - counter of vertices in path
- * @param cost - current cost of travel
- * @param ans - Optimal travelling cost
- * @return ans
- * @details Time Complexity O(v) -> v: number of vertices
-*/
-double Management::tspBacktrackingAlgorithm(Graph *graph, int currIdx, int n, int count, double cost, double& ans) {
-
-    // Base case: If all nodes are visited and there is a path back to the starting point
-    if (count == n) {
-        for (Edge *edge : graph->getVertexSet()[currIdx]->getAdj()) {
-            if (edge->getDest() == graph->getVertexSet()[0]) {  // Assuming the start is the first vertex
-                ans = std::min(ans, cost + edge->getWeight());
-            }
-        }
-        return ans;
-    }
-
-    //adjacent vertices
-    for (Edge *edge : graph->getVertexSet()[currIdx]->getAdj()) {
-        int nextIdx = graph->findVertexIdx(edge->getDest()->getInfo());
-        Vertex * v = graph->getVertexSet()[nextIdx];
-        if (!v->isVisited()) {
-            v->setVisited(true);
-            tspBacktrackingAlgorithm(graph, nextIdx, n, count + 1, cost + edge->getWeight(), ans);
-            v->setVisited(false);
-        }
-    }
+ * @brief Sets where the exact searches save their frontier, so a run that is stopped can be resumed by the next one
+ * on the same dataset
+ * @param file checkpoint file, empty for none
+ * @param intervalMs time between two saves
+ */
+void Management::setCheckpoint(const std::string &file, long intervalMs) {
+    checkpointFile = file;
+    checkpointIntervalMs = intervalMs;
+}
 
-    return ans;
+/**
+ * @brief Runs the branch and bound of ExactSearch from a vertex, seeded with the space-filling curve tour when it
+ * follows the edges, and checkpointed if a checkpoint file is set
+ * @param graph
+ * @param startIdx index in the vertex set of the vertex where the tour starts
+ * @param timeLimitMs time after which the search stops with the best tour so far, 0 for none
+ * @param complete if not null, set to whether the whole tree was searched
+ * @return Cost of the optimal tour, INF if there is none
+ * @details Time Complexity O(v!) -> v: number of vertices
+ */
+double Management::exactSearch(Graph *graph, int startIdx, long timeLimitMs, bool *complete) {
+    ExactSearch search(graph, startIdx);
+    search.setTimeLimit(timeLimitMs);
+    std::vector<int> seed;
+    tspSpaceFillingCurve(graph, &seed);
+    double seedCost = tourEdgeCost(graph, seed);
+    if (seedCost != INF)
+        search.setIncumbent(seedCost, seed);
+    if (!checkpointFile.empty())
+        search.setCheckpoint(checkpointFile, checkpointIntervalMs);
+    double cost = search.run();
+    if (complete != nullptr)
+        *complete = search.isComplete();
+    return cost;
 }
 
 
 /**
  * @brief Triangular approximation heuristic
  * @param graph fully connected graph
+ * @param tour if not null, receives the tour (vertex infos, starting at node 0 of the dataset, without repeating it)
  * @return Cost of the approximate tour
  * @details Time Complexity O(v²log(v)) -> v: number of vertices
  */
-double Management::tspTriangular(Graph *graph) {
+double Management::tspTriangular(Graph *graph, std::vector<int> *tour) {
+    TRACE_SPAN("tspTriangular", "solve");
 
-    mst(graph, 0);
+    // node 0 of the dataset, which has another info if the vertices were renumbered at load time
+    int start = graph->getInternalId(0);
+    mst(graph, start);
 
-    for (Vertex *v: graph->getVertexSet()) {
-        v->setVisited(false);
+    Vertex *r = graph->findVertex(start);
+    if (r == nullptr) {
+        return 0;
     }
 
     double cost = 0;
     std::vector<Vertex *> path;
-    Vertex *r = graph->findVertex(0);
-    if (r == nullptr) {
-        return 0;
-    }
+    {
+        STATS_TIMER(Phase::Preorder);
+        TRACE_SPAN("preorderVisit", "solve");
 
-    path.push_back(r);
+        for (Vertex *v: graph->getVertexSet()) {
+            v->setVisited(false);
+        }
 
-    for (Vertex *v: r->getChildren()) {
-        preorderVisit(graph, v, cost, path);
+        path.push_back(r);
+
+        for (Vertex *v: r->getChildren()) {
+            preorderVisit(graph, v, cost, path);
+        }
     }
 
     // add last edge
@@ -119,7 +246,13 @@ double Management::tspTriangular(Graph *graph) {
         cost += graph->getDist(path.back()->getInfo(), r->getInfo());
         path.push_back(r);
     }
+    Memory::noteScratch(path.capacity() * sizeof(Vertex *));
 
+    if (tour != nullptr) {
+        tour->clear();
+        for (size_t i = 0; i < path.size() && (i == 0 || path[i] != r); i++)
+            tour->push_back(path[i]->getInfo());
+    }
     return cost;
 }
 
@@ -128,9 +261,12 @@ double Management::tspTriangular(Graph *graph) {
  * @brief Gets the minimum spanning tree (mst) using Prim's algorithm
  * @param graph graph to get the mst
  * @param start vertex to start mst
- * @details Time Complexity O(v²log(v)) -> v: number of vertices
+ * @details The tree is stored in the parent and children of each vertex.
+ * Time Complexity O(v² / t) -> v: number of vertices, t: number of threads
  */
 void Management::mst(Graph *graph, int start) {
+    STATS_TIMER(Phase::Mst);
+    TRACE_SPAN("mst", "solve");
 
     for (Vertex *v : graph->getVertexSet()) {
         v->setVisited(false);
@@ -139,41 +275,90 @@ void Management::mst(Graph *graph, int start) {
         v->clearChildren();
     }
 
-    Vertex *r = graph->findVertex(start);
-    if (r == nullptr) {
+    int root = graph->findVertexIdx(start);
+    if (root < 0) {
         return;
     }
-    r->setDist(0);
 
-    std::priority_queue<std::pair<Vertex *, double>, std::vector<std::pair<Vertex *, double>>, Vertex::greaterDist> minHeap;
-    for (Vertex *v: graph->getVertexSet()) {
-        minHeap.push(std::make_pair(v, v->getDist()));
+    auto vertices = graph->getVertexSet();
+    std::vector<int> parent = primParents(graph, root);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        if (parent[i] >= 0)
+            vertices[i]->setParent(vertices[parent[i]]);
     }
 
-    int verticeCount = 0;
-    while (!minHeap.empty() && verticeCount < graph->getNumVertex()) {
-        Vertex *v = minHeap.top().first;
-        minHeap.pop();
-        if (v->isVisited())
-            continue;
-        v->setVisited(true);
-        verticeCount++;
-
-        for (Vertex *w : graph->getVertexSet()) {
-            if (w->isVisited())
-                continue;
+    // set for each vertex the children that were visited after it
+    setChildren(graph);
+}
 
-            double dist = graph->getDist(v->getInfo(), w->getInfo());
-            if (dist < w->getDist()) {
-                w->setParent(v);
-                w->setDist(dist);
-                minHeap.push(std::make_pair(w, dist));
+/**
+ * @brief Dense Prim's algorithm over the distance matrix, on vertex set indices. After a vertex joins the tree, its
+ * row is scanned in parallel blocks that relax the keys of the vertices outside the tree and find the closest one.
+ * @param graph graph with a complete distance matrix
+ * @param root index of the vertex the tree grows from
+ * @param penalty if not null, the weight of (i, j) is d(i, j) + penalty[i] + penalty[j]
+ * @param skip index of a vertex left out of the tree, -1 to span every vertex
+ * @param deadline time after which the tree is abandoned, checked before each row
+ * @return index of the parent of each vertex, -1 for the root and for skip; empty if the deadline passed first
+ * @details Time Complexity O(v² / t) -> v: number of vertices, t: number of threads
+ */
+std::vector<int> Management::primParents(Graph *graph, int root, const std::vector<double> *penalty, int skip,
+                                         std::chrono::steady_clock::time_point deadline) {
+    const bool bounded = deadline != std::chrono::steady_clock::time_point::max();
+    const int GRAIN = 2048;
+    auto vertices = graph->getVertexSet();
+    int n = vertices.size();
+    std::vector<int> infos(n);
+    for (int i = 0; i < n; i++)
+        infos[i] = vertices[i]->getInfo();
+
+    std::vector<int> parent(n, -1);
+    std::vector<double> key(n, INF);
+    std::vector<char> inTree(n, 0);
+    if (skip >= 0)
+        inTree[skip] = 1;
+    std::vector<std::pair<double, int>> blockBest((n + GRAIN - 1) / GRAIN);
+    Memory::noteScratch(n * (sizeof(int) * 2 + sizeof(double) + 1));
+
+    int u = root;
+    int added = skip >= 0 ? 2 : 1;
+    inTree[u] = 1;
+    while (added < n) {
+        if (bounded && std::chrono::steady_clock::now() >= deadline)
+            return {};
+        double pu = penalty != nullptr ? (*penalty)[u] : 0;
+        ThreadPool::global().parallelFor(0, n, GRAIN, [&](int lo, int hi) {
+            std::pair<double, int> best = {INF, -1};
+            for (int j = lo; j < hi; j++) {
+                if (inTree[j])
+                    continue;
+                double w = graph->getDist(infos[u], infos[j]);
+                if (penalty != nullptr)
+                    w += pu + (*penalty)[j];
+                if (w < key[j]) {
+                    key[j] = w;
+                    parent[j] = u;
+                }
+                if (key[j] < best.first)
+                    best = {key[j], j};
             }
+            blockBest[lo / GRAIN] = best;
+        });
+        STATS_INC(Counter::MstRowScans);
+
+        // blocks are in index order, so ties go to the lowest index whatever the thread count
+        std::pair<double, int> best = {INF, -1};
+        for (const auto &b : blockBest) {
+            if (b.second != -1 && (best.second == -1 || b.first < best.first))
+                best = b;
         }
+        if (best.second == -1)
+            break;
+        u = best.second;
+        inTree[u] = 1;
+        added++;
     }
-
-    // set for each vertex the children that were visited after it
-    setChildren(graph);
+    return parent;
 }
 
 /**
@@ -182,6 +367,7 @@ void Management::mst(Graph *graph, int start) {
  * @details Time Complexity O(v) -> v: number of vertices
  */
 void Management::setChildren(Graph *graph) {
+    TRACE_SPAN("setChildren", "solve");
 
     for (Vertex *v: graph->getVertexSet()) {
         if (v->getParent() != nullptr) {
@@ -211,17 +397,20 @@ void Management::preorderVisit(Graph *g, Vertex *v, double &cost, std::vector<Ve
 /**
  * @brief Performs the nearest neighbour tsp algorithm
  * @param graph fully connected graph
+ * @param tour if not null, receives the tour (vertex infos, starting at node 0 of the dataset, without repeating it)
  * @return Cost of the approximate tour
  * @details Time Complexity O(v²) -> v: number of vertices
  */
-double Management::tspOther(Graph *graph) {
+double Management::tspOther(Graph *graph, std::vector<int> *tour) {
+    TRACE_SPAN("tspOther", "solve");
     double cost = 0;
 
     for (Vertex *v : graph->getVertexSet()) {
         v->setVisited(false);
     }
 
-    Vertex *last = graph->findVertex(0);
+    int start = graph->getInternalId(0);
+    Vertex *last = graph->findVertex(start);
 
     std::vector<int> path;
     path.push_back(last->getInfo());
@@ -246,8 +435,11 @@ double Management::tspOther(Graph *graph) {
         cost += minCost;
     }
 
-    cost += graph->getDist(path.back(), 0);
+    cost += graph->getDist(path.back(), start);
+    Memory::noteScratch(path.capacity() * sizeof(int));
 
+    if (tour != nullptr)
+        *tour = std::move(path);
     return cost;
 }
 
@@ -256,64 +448,391 @@ double Management::tspOther(Graph *graph) {
  * @brief Performs a branch and bound algorithm
  * @param graph
  * @param start vertex to start the tour
+ * @param timeLimitMs time after which the search stops with the best tour so far, 0 for none
+ * @param complete if not null, set to whether the whole tree was searched, so the cost is the optimal one
  * @return Cost of the tour if it exists else 0
- * @details @details Time Complexity O(v!) -> v: number of vertices
+ * @details Runs the iterative search of ExactSearch, so long runs can be checkpointed and resumed.
+ * Time Complexity O(v!) -> v: number of vertices
  */
-double Management::tspRealWorld(Graph *graph, int start) {
-
-    std::vector<int> curPath;
-    std::vector<int> path;
-    double minCost = INF;
-
+double Management::tspRealWorld(Graph *graph, int start, long timeLimitMs, bool *complete) {
+    if (complete != nullptr)
+        *complete = true;
     for (Vertex *v : graph->getVertexSet()) {
-        v->setVisited(false);
         if (v->getAdj().size() < 2) {
             return 0;
         }
     }
+    int startIdx = graph->findVertexIdx(start);
+    if (startIdx < 0)
+        return 0;
+
+    STATS_TIMER(Phase::Search);
+    TRACE_SPAN("tspRealWorld", "solve");
+    return exactSearch(graph, startIdx, timeLimitMs, complete);
+}
+
+
+/**
+ * @brief Space-filling curve heuristic: visits the vertices in the order of their coordinates along a curve.
+ * Vertices close on the curve are close on the map, so the tour has few long jumps.
+ * @param graph graph whose vertices have coordinates, without them the vertex set order is used
+ * @param tour if not null, receives the tour (vertex infos, starting at node 0 of the dataset, without repeating it)
+ * @param curve curve to order the vertices by
+ * @return Cost of the approximate tour, using the distance matrix
+ * @details Time Complexity O(v log(v) / t) -> v: number of vertices, t: number of threads
+ */
+double Management::tspSpaceFillingCurve(Graph *graph, std::vector<int> *tour, Curve curve) {
+    TRACE_SPAN("tspSpaceFillingCurve", "solve");
+    if (graph->getNumVertex() == 0)
+        return 0;
 
-    Vertex *startV = graph->findVertex(start);
-    tspBB(graph, startV, graph->getNumVertex(), curPath, 0, minCost);
+    std::vector<int> path = curveTour(graph, curve);
+    double cost = tourCost(graph, path);
+    if (tour != nullptr)
+        *tour = std::move(path);
+    return cost;
+}
 
-    return minCost;
+/**
+ * @brief Tour visiting the vertices in the order of a space-filling curve over their coordinates.
+ * Only the vertices and their coordinates are read, never the distances or the edges, so it can run while the rest
+ * of the graph is still loading.
+ * @param graph graph whose vertices have coordinates
+ * @param curve curve to follow
+ * @return vertex infos of the tour, starting at node 0 of the dataset
+ * @details Time Complexity O(v log v) -> v: number of vertices
+ */
+std::vector<int> Management::curveTour(Graph *graph, Curve curve) {
+    auto vertices = graph->getVertexSet();
+    int n = vertices.size();
+    if (n == 0)
+        return {};
+
+    std::vector<double> xs(n), ys(n);
+    for (int i = 0; i < n; i++) {
+        xs[i] = vertices[i]->getLon();
+        ys[i] = vertices[i]->getLat();
+    }
+    std::vector<int> order = SpaceFillingCurve::order(xs, ys, curve);
+
+    // rotate the cycle so it starts at node 0 of the dataset
+    int start = graph->getInternalId(0);
+    auto first = std::find_if(order.begin(), order.end(), [&](int idx) { return vertices[idx]->getInfo() == start; });
+    if (first != order.end())
+        std::rotate(order.begin(), first, order.end());
+
+    std::vector<int> path(n);
+    for (int i = 0; i < n; i++)
+        path[i] = vertices[order[i]]->getInfo();
+    Memory::noteScratch(n * (2 * sizeof(double) + sizeof(std::pair<uint64_t, int>) + 2 * sizeof(int)));
+    return path;
 }
 
+/**
+ * @brief 2-opt local search over the 10 nearest neighbours of every vertex, while that shortens the tour
+ * @param graph graph with a complete distance matrix
+ * @param tour seed tour (vertex infos, without repeating the first one), improved in place
+ * @param timeLimitMs time after which the search stops with the best tour so far
+ * @param stop if not null, once set the search stops as at the time limit, and the tour is left as it was if the
+ * candidate lists were not finished
+ * @return Cost of the improved tour
+ * @details The moves run on a Tour, so big instances get the two-level list and flips stay sublinear.
+ * Time Complexity O(v² / t) for the candidate lists, then O(k) per vertex checked plus one flip per improving move
+ * -> v: number of vertices, t: number of threads, k: candidates per vertex
+ */
+double Management::improveTwoOpt(Graph *graph, std::vector<int> &tour, long timeLimitMs,
+                                 const std::atomic<bool> *stop) {
+    TRACE_SPAN("improveTwoOpt", "solve");
+    int n = tour.size();
+    if (n < 4)
+        return tourCost(graph, tour);
+
+    CandidateLists cand(graph, 10, CandidateSource::Matrix, stop);
+    if (stop != nullptr && *stop)
+        return tourCost(graph, tour);
+    std::unordered_map<int, int> index;
+    index.reserve(n);
+    for (int i = 0; i < n; i++)
+        index[cand.getInfo(i)] = i;
+    std::vector<int> order(n);
+    for (int i = 0; i < n; i++)
+        order[i] = index[tour[i]];
+
+    std::unique_ptr<Tour> t = Tour::create(order);
+    improveTwoOptCandidates(cand, *t, timeLimitMs, stop);
+    order = t->toVector(order[0]);
+    for (int i = 0; i < n; i++)
+        tour[i] = cand.getInfo(order[i]);
+    return tourCost(graph, tour);
+}
 
 /**
- * @brief Auxiliary recursive function of branch and bound algorithm
- * @param g
- * @param cur last vertex to be added to the path
- * @param n number of vertices
- * @param curPath current path
- * @param cost current cost
- * @param minCost minimum cost so far
- * @details @details Time Complexity O(v!) -> v: number of vertices
+ * @brief 2-opt over the candidate lists with a work queue: for a vertex a with tour neighbour b (on either side) and
+ * a candidate c with neighbour d on the same side, replaces (a, b) and (c, d) by (a, c) and (b, d) if that is
+ * shorter. The four endpoints of every applied move go back in the queue, and the search ends when it is empty.
+ * @param cand candidate lists
+ * @param tour tour of vertex indices, improved in place
+ * @param timeLimitMs time after which the search stops, 0 for no limit
+ * @param stop if not null, the search stops once it is set
+ * @details Only candidates closer to a than b are tried, since otherwise the move cannot gain.
+ * Time Complexity O(k) per vertex checked plus one flip per improving move -> k: candidates per vertex
  */
-void Management::tspBB(Graph *g, Vertex *cur, int n, std::vector<int> curPath, double cost, double &minCost) {
-    cur->setVisited(true);
-    if (cost >= minCost) {
-        cur->setVisited(false);
+void Management::improveTwoOptCandidates(const CandidateLists &cand, Tour &tour, long timeLimitMs,
+                                         const std::atomic<bool> *stop) {
+    int n = tour.size();
+    if (n < 4)
         return;
-    }
-    curPath.push_back(cur->getInfo());
-
-    if (curPath.size() == n) {
-        for (Edge *e : cur->getAdj()) {
-            if (g->findVertex(curPath[0])->getInfo() == e->getDest()->getInfo()) {
-                cost += e->getWeight();
-                curPath.push_back(g->findVertex(curPath[0])->getInfo());
-                if (cost < minCost) {
-                    minCost = cost;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimitMs);
+
+    std::deque<int> queue;
+    std::vector<char> queued(n, 1);
+    for (int v = 0; v < n; v++)
+        queue.push_back(v);
+
+    long checked = 0;
+    while (!queue.empty()) {
+        if ((++checked & 255) == 0 && ((stop != nullptr && *stop) ||
+                                        (timeLimitMs > 0 && std::chrono::steady_clock::now() >= deadline)))
+            break;
+        int a = queue.front();
+        queue.pop_front();
+        queued[a] = 0;
+
+        bool moved = false;
+        for (int side = 0; side < 2 && !moved; side++) {
+            int b = side == 0 ? tour.next(a) : tour.prev(a);
+            double dAB = cand.dist(a, b);
+            for (int c : cand.of(a)) {
+                double dAC = cand.dist(a, c);
+                // candidates are sorted, so no later one can give a gain
+                if (dAC >= dAB)
+                    break;
+                int d = side == 0 ? tour.next(c) : tour.prev(c);
+                if (c == b || d == a)
+                    continue;
+                if (dAC + cand.dist(b, d) - dAB - cand.dist(c, d) < -1e-9) {
+                    if (side == 0)
+                        tour.flip(a, b, c, d);
+                    else
+                        tour.flip(b, a, d, c);
+                    for (int v : {a, b, c, d}) {
+                        if (!queued[v]) {
+                            queued[v] = 1;
+                            queue.push_back(v);
+                        }
+                    }
+                    moved = true;
+                    break;
                 }
             }
         }
     }
+}
+
+/**
+ * @brief 2-opt over the candidate lists on a tour stored as a vector
+ * @param cand candidate lists
+ * @param tour vertex indices of the tour, improved in place
+ */
+void Management::improveTwoOptCandidates(const CandidateLists &cand, std::vector<int> &tour) {
+    if (tour.size() < 4)
+        return;
+    std::unique_ptr<Tour> t = Tour::create(tour);
+    improveTwoOptCandidates(cand, *t);
+    tour = t->toVector(tour[0]);
+}
+
+/**
+ * @brief Cost of a closed tour using the distance matrix
+ * @param graph
+ * @param tour vertex infos, without repeating the first one
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+double Management::tourCost(Graph *graph, const std::vector<int> &tour) {
+    double cost = 0;
+    for (size_t i = 0; i + 1 < tour.size(); i++)
+        cost += graph->getDist(tour[i], tour[i + 1]);
+    if (tour.size() > 1)
+        cost += graph->getDist(tour.back(), tour.front());
+    return cost;
+}
+
+/**
+ * @brief Cost of a closed tour following only the edges of the graph
+ * @param graph
+ * @param tour vertex infos, without repeating the first one
+ * @return Cost of the tour, INF if two consecutive vertices are not connected by an edge
+ * @details Time Complexity O(v + e) -> v: number of vertices, e: number of edges
+ */
+double Management::tourEdgeCost(Graph *graph, const std::vector<int> &tour) {
+    if (tour.size() < 2)
+        return INF;
 
-    for (Edge *e : cur->getAdj()) {
-        if (!e->getDest()->isVisited()) {
-            tspBB(g, e->getDest(), n, curPath, cost + e->getWeight(), minCost);
+    std::unordered_map<int, Vertex *> byInfo;
+    byInfo.reserve(graph->getNumVertex());
+    for (Vertex *v : graph->getVertexSet())
+        byInfo[v->getInfo()] = v;
+
+    double cost = 0;
+    for (size_t i = 0; i < tour.size(); i++) {
+        int to = tour[(i + 1) % tour.size()];
+        double weight = INF;
+        for (Edge *e : byInfo[tour[i]]->getAdj()) {
+            if (e->getDest()->getInfo() == to)
+                weight = std::min(weight, e->getWeight());
         }
+        if (weight == INF)
+            return INF;
+        cost += weight;
     }
+    return cost;
+}
+
 
-    cur->setVisited(false);
-}
\ No newline at end of file
+/**
+ * @brief Greedy edge heuristic: takes the candidate edges from the shortest up, skipping those that would give a
+ * vertex a third edge or close a cycle early, then joins the resulting paths into a tour
+ * @param graph graph with a complete distance matrix
+ * @param tour if not null, receives the tour (vertex infos, starting at node 0 of the dataset, without repeating it)
+ * @param k nearest neighbours of each vertex considered as candidate edges
+ * @return Cost of the approximate tour
+ * @details Time Complexity O(v² / t + v k log(v k)) -> v: number of vertices, t: number of threads
+ */
+double Management::tspGreedyEdge(Graph *graph, std::vector<int> *tour, int k) {
+    TRACE_SPAN("tspGreedyEdge", "solve");
+    CandidateLists cand(graph, k);
+    int n = cand.size();
+    if (n == 0)
+        return 0;
+
+    std::vector<CandidateEdge> edges = candidateEdges(cand, -1, [&](int v, int w) { return cand.dist(v, w); });
+    ThreadPool::global().parallelSort(edges, std::less<>());
+    Memory::noteScratch(edges.capacity() * sizeof(CandidateEdge));
+
+    std::vector<std::array<int, 2>> links = matchEdges(n, edges);
+    int start = std::max(0, graph->findVertexIdx(graph->getInternalId(0)));
+    return finishTour(graph, cand, joinFragments(cand, links, start), tour);
+}
+
+/**
+ * @brief Clarke-Wright savings heuristic: starts from a route hub -> v -> hub for every vertex and merges routes
+ * in decreasing order of the saving d(hub, v) + d(hub, w) - d(v, w), under the same degree and cycle rules as the
+ * greedy edge heuristic
+ * @param graph graph with a complete distance matrix
+ * @param tour if not null, receives the tour (vertex infos, starting at node 0 of the dataset, without repeating it)
+ * @param k nearest neighbours of each vertex considered as candidate merges
+ * @return Cost of the approximate tour
+ * @details The hub is node 0 of the dataset, or the first vertex of the vertex set if there is no node 0.
+ * Time Complexity O(v² / t + v k log(v k)) -> v: number of vertices, t: number of threads
+ */
+double Management::tspSavings(Graph *graph, std::vector<int> *tour, int k) {
+    TRACE_SPAN("tspSavings", "solve");
+    CandidateLists cand(graph, k);
+    int n = cand.size();
+    if (n == 0)
+        return 0;
+
+    int hub = std::max(0, graph->findVertexIdx(graph->getInternalId(0)));
+    std::vector<CandidateEdge> edges = candidateEdges(cand, hub, [&](int v, int w) {
+        // negated, so the biggest saving sorts first
+        return cand.dist(v, w) - cand.dist(hub, v) - cand.dist(hub, w);
+    });
+    ThreadPool::global().parallelSort(edges, std::less<>());
+    Memory::noteScratch(edges.capacity() * sizeof(CandidateEdge));
+
+    // the hub is left alone, every remaining route is joined through it
+    std::vector<std::array<int, 2>> links = matchEdges(n, edges);
+    return finishTour(graph, cand, joinFragments(cand, links, hub), tour);
+}
+
+/**
+ * @brief Joins the paths left by the edge matching into a single tour: from the end of the current path, moves to
+ * the nearest free path end (looked up in the candidate lists first, then among every path end) and walks that path
+ * @param cand candidate lists
+ * @param links links of each vertex, -1 where there is none; every component must be a path
+ * @param start index of the vertex the tour starts at
+ * @return vertex indices in tour order, starting at start
+ * @details Time Complexity O(v + p²) -> v: number of vertices, p: number of paths not joined through the lists
+ */
+std::vector<int> Management::joinFragments(const CandidateLists &cand, std::vector<std::array<int, 2>> &links, int start) {
+    int n = cand.size();
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<bool> used(n, false);
+
+    // other end of the path whose end is v
+    auto walk = [&](int v) {
+        int prev = -1;
+        while (true) {
+            order.push_back(v);
+            used[v] = true;
+            int next = links[v][0] != prev ? links[v][0] : links[v][1];
+            if (next == -1 || next == prev)
+                return v;
+            prev = v;
+            v = next;
+        }
+    };
+
+    std::vector<int> ends;
+    for (int v = 0; v < n; v++) {
+        if (links[v][1] == -1)
+            ends.push_back(v);
+    }
+
+    // the first path is the one through start, walked from one of its ends; the tour is rotated to start afterwards
+    int first = start;
+    if (links[start][1] != -1) {
+        int prev = start, v = links[start][0];
+        while (links[v][1] != -1) {
+            int next = links[v][0] != prev ? links[v][0] : links[v][1];
+            prev = v;
+            v = next;
+        }
+        first = v;
+    }
+
+    int cur = walk(first);
+    while ((int) order.size() < n) {
+        int best = -1;
+        for (int w : cand.of(cur)) {
+            if (!used[w] && links[w][1] == -1) {
+                best = w;
+                break;
+            }
+        }
+        if (best == -1) {
+            double bestDist = INF;
+            for (int w : ends) {
+                if (!used[w] && cand.dist(cur, w) < bestDist) {
+                    bestDist = cand.dist(cur, w);
+                    best = w;
+                }
+            }
+        }
+        cur = walk(best);
+    }
+
+    std::rotate(order.begin(), std::find(order.begin(), order.end(), start), order.end());
+    return order;
+}
+
+/**
+ * @brief Turns a tour of vertex indices into vertex infos and computes its cost
+ * @param graph
+ * @param cand candidate lists the indices refer to
+ * @param order vertex indices in tour order
+ * @param tour if not null, receives the tour as vertex infos
+ * @return Cost of the tour
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+double Management::finishTour(Graph *graph, const CandidateLists &cand, const std::vector<int> &order,
+                              std::vector<int> *tour) {
+    std::vector<int> path(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+        path[i] = cand.getInfo(order[i]);
+    double cost = tourCost(graph, path);
+    if (tour != nullptr)
+        *tour = std::move(path);
+    return cost;
+}
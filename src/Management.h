@@ -3,6 +3,14 @@
 
 #include "Graph.h"
 #include "Vertex.h"
+#include "SpaceFillingCurve.h"
+#include "Candidates.h"
+#include "Tour.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
 
 /**
  * @brief Management Class Definition
@@ -10,22 +18,43 @@
 class Management {
 
 public:
-    static double tspBacktracking(Graph *graph);
-    static double tspTriangular(Graph* graph);
-    static double tspOther(Graph* graph);
-    static double tspRealWorld(Graph* graph, int start);
+    static double tspBacktracking(Graph *graph, long timeLimitMs = 0, bool *complete = nullptr);
+    static double tspTriangular(Graph* graph, std::vector<int> *tour = nullptr);
+    static double tspOther(Graph* graph, std::vector<int> *tour = nullptr);
+    static double tspRealWorld(Graph* graph, int start, long timeLimitMs = 0, bool *complete = nullptr);
+    static double tspSpaceFillingCurve(Graph *graph, std::vector<int> *tour = nullptr, Curve curve = Curve::Hilbert);
+    static std::vector<int> curveTour(Graph *graph, Curve curve = Curve::Hilbert);
+    static double tspGreedyEdge(Graph *graph, std::vector<int> *tour = nullptr, int k = 10);
+    static double tspSavings(Graph *graph, std::vector<int> *tour = nullptr, int k = 10);
+    static double improveTwoOpt(Graph *graph, std::vector<int> &tour, long timeLimitMs,
+                                const std::atomic<bool> *stop = nullptr);
+    static void improveTwoOptCandidates(const CandidateLists &cand, Tour &tour, long timeLimitMs = 0,
+                                        const std::atomic<bool> *stop = nullptr);
+    static void improveTwoOptCandidates(const CandidateLists &cand, std::vector<int> &tour);
+    static double tourCost(Graph *graph, const std::vector<int> &tour);
+    static double tourEdgeCost(Graph *graph, const std::vector<int> &tour);
     static double getHaversineDist(Vertex *v1, Vertex *v2);
+    static std::vector<int> primParents(Graph *graph, int root, const std::vector<double> *penalty = nullptr,
+                                        int skip = -1, std::chrono::steady_clock::time_point deadline =
+                                                std::chrono::steady_clock::time_point::max());
+    static void setCheckpoint(const std::string &file, long intervalMs);
 
 private:
-    static double tspBacktrackingAlgorithm(Graph *graph, int currIdx, int n, int count, double cost, double& ans);
-
     static void mst(Graph *graph, int start);
     static void setChildren(Graph *graph);
     static void preorderVisit(Graph *g, Vertex *v, double &cost, std::vector<Vertex *> &path);
 
-    static void tspBB(Graph *g, Vertex *cur, int n, std::vector<int> curPath, double cost, double &minCost);
+    static double exactSearch(Graph *graph, int startIdx, long timeLimitMs, bool *complete);
+
+    static std::vector<int> joinFragments(const CandidateLists &cand, std::vector<std::array<int, 2>> &links, int start);
+    static double finishTour(Graph *graph, const CandidateLists &cand, const std::vector<int> &order,
+                             std::vector<int> *tour);
 
     static double convert(const double angle);
+
+    // file the exact searches save their frontier to, empty for none, and the time between two saves
+    static std::string checkpointFile;
+    static long checkpointIntervalMs;
 };
 
 
@@ -0,0 +1,131 @@
+#include "Memory.h"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <unistd.h>
+
+std::atomic<size_t> Memory::limit{0};
+std::atomic<size_t> Memory::scratch{0};
+
+/**
+ * @brief Sum of every component
+ */
+size_t MemoryUsage::total() const {
+    return matrix + vertices + edges + scratch;
+}
+
+/**
+ * @brief Resident set size of the process right now
+ * @return bytes, 0 if unknown on this platform
+ */
+size_t Memory::currentRSS() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (statm >> pages >> resident)
+        return resident * (size_t) sysconf(_SC_PAGESIZE);
+    return 0;
+}
+
+/**
+ * @brief Highest resident set size reached by the process
+ * @return bytes
+ */
+size_t Memory::peakRSS() {
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return (size_t) usage.ru_maxrss;
+#else
+    return (size_t) usage.ru_maxrss * 1024;
+#endif
+}
+
+/**
+ * @brief Sets the memory limit checked before large allocations
+ * @param bytes limit, 0 for no limit
+ */
+void Memory::setLimit(size_t bytes) {
+    limit = bytes;
+}
+
+size_t Memory::getLimit() {
+    return limit;
+}
+
+/**
+ * @brief Whether allocating more bytes keeps the process under the limit
+ * @param bytes bytes about to be allocated
+ */
+bool Memory::fits(size_t bytes) {
+    size_t l = limit;
+    return l == 0 || currentRSS() + bytes <= l;
+}
+
+/**
+ * @brief Fails fast when an allocation would exceed the memory limit
+ * @param what name of what is being allocated, used in the error message
+ * @param bytes estimated size of the allocation
+ * @throws std::runtime_error with the estimate if it does not fit
+ */
+void Memory::checkFits(const std::string &what, size_t bytes) {
+    if (fits(bytes))
+        return;
+    throw std::runtime_error("Not enough memory for the " + what + ": it needs about " + format(bytes) +
+                             " on top of the " + format(currentRSS()) + " in use, but the limit is " + format(limit) + ".");
+}
+
+/**
+ * @brief Forgets the scratch memory recorded by the previous solver run
+ */
+void Memory::resetScratch() {
+    scratch = 0;
+}
+
+/**
+ * @brief Records the scratch memory held by a solver, keeping the highest value since the last reset
+ * @param bytes bytes held by the solver at this point
+ */
+void Memory::noteScratch(size_t bytes) {
+    size_t cur = scratch.load(std::memory_order_relaxed);
+    while (bytes > cur && !scratch.compare_exchange_weak(cur, bytes, std::memory_order_relaxed)) {}
+}
+
+size_t Memory::peakScratch() {
+    return scratch;
+}
+
+/**
+ * @brief Human readable size
+ * @param bytes size in bytes
+ * @return size in B, KB, MB or GB
+ */
+std::string Memory::format(size_t bytes) {
+    const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = bytes;
+    int unit = 0;
+    while (value >= 1024 && unit < 4) {
+        value /= 1024;
+        unit++;
+    }
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(unit == 0 ? 0 : 2) << value << units[unit];
+    return oss.str();
+}
+
+/**
+ * @brief Formats the components of a memory usage together with the peak RSS of the process
+ * @param usage bytes per component
+ * @return one line per component
+ */
+std::string Memory::report(const MemoryUsage &usage) {
+    std::ostringstream oss;
+    oss << " - Distance matrix: " << format(usage.matrix) << "\n";
+    oss << " - Vertices: " << format(usage.vertices) << "\n";
+    oss << " - Edges: " << format(usage.edges) << "\n";
+    oss << " - Solver scratch: " << format(usage.scratch) << "\n";
+    oss << " - Peak RSS: " << format(peakRSS()) << "\n";
+    return oss.str();
+}
@@ -0,0 +1,45 @@
+#ifndef PROJECT2_MEMORY_H
+#define PROJECT2_MEMORY_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Bytes held by each component of a graph and by the last solver run
+ */
+struct MemoryUsage {
+    size_t matrix = 0;
+    size_t vertices = 0;
+    size_t edges = 0;
+    size_t scratch = 0;
+
+    size_t total() const;
+};
+
+/**
+ * @brief Memory accounting: process RSS, solver scratch tracking and the configured memory limit
+ */
+class Memory {
+public:
+    static size_t currentRSS();
+    static size_t peakRSS();
+
+    static void setLimit(size_t bytes);
+    static size_t getLimit();
+    static void checkFits(const std::string &what, size_t bytes);
+    static bool fits(size_t bytes);
+
+    static void resetScratch();
+    static void noteScratch(size_t bytes);
+    static size_t peakScratch();
+
+    static std::string format(size_t bytes);
+    static std::string report(const MemoryUsage &usage);
+
+private:
+    static std::atomic<size_t> limit;
+    static std::atomic<size_t> scratch;
+};
+
+#endif //PROJECT2_MEMORY_H
@@ -1,19 +1,130 @@
 #include "Menu.h"
 #include "Auxiliar.h"
 #include "Management.h"
+#include "ThreadPool.h"
+#include "GeneticSearch.h"
+#include "AntColony.h"
+#include "SimulatedAnnealing.h"
+#include "LowerBound.h"
+#include "ResultCache.h"
+#include "Portfolio.h"
 
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 
 
 /**
- * @brief Constructor of the Menu class. Stores the graph containing all of the chosen dataset information
- * in the private field.
- * @param g Graph containing all of the dataset information
+ * @brief Constructor of the Menu class. The dataset keeps loading in the background, and the menu takes the graph
+ * over when it is ready.
+ * @param loader Load of the dataset, already running
+ * @param dataset Index of the dataset being loaded, negative if it is read from another file
+ * @param datasetName Name shown for a dataset read from another file, until the load gives its own
  */
-Menu::Menu(Graph *g) : g(g)  {}
+Menu::Menu(std::unique_ptr<DatasetLoader> loader, int dataset, const std::string &datasetName)
+        : loader(std::move(loader)), curDataset(dataset), loadedDataset(dataset), customDataset(datasetName) {}
+
+/**
+ * @brief Cancels a load and a 2-opt of the early tour still running and frees the graph
+ */
+Menu::~Menu() {
+    loader.reset();
+    cancelRefinement();
+    delete g;
+}
+
+/**
+ * @brief Waits for the dataset being loaded, if any, showing its progress, and takes its graph over
+ * @return true if there is a graph to run the algorithms on
+ * @details If the load failed, the previous graph stays and loadError says why.
+ */
+bool Menu::waitForGraph() {
+    if (loader == nullptr)
+        return g != nullptr;
+    loader->waitWithProgress(std::cout);
+    try {
+        Graph *loaded = loader->take();
+        cancelRefinement();
+        delete g;
+        g = loaded;
+        loadStats = loader->getStats();
+        earlyTour = loader->getEarlyTour();
+        refineEarlyTour();
+        earlyTourMs = loader->getEarlyTourMs();
+        loadMs = loader->getLoadMs();
+        checksum = loader->getChecksum();
+        lowerBound = -1;
+        loadedDataset = curDataset;
+        if (!loader->getName().empty())
+            customDataset = loader->getName();
+    } catch (const std::runtime_error &e) {
+        curDataset = loadedDataset;
+        loadError = e.what();
+    }
+    loader.reset();
+    return g != nullptr;
+}
+
+/**
+ * @brief Checks that a node id of the dataset is in the loaded graph
+ * @param original id of the node in the dataset
+ * @return true if the graph has that node
+ */
+bool Menu::hasNode(int original) const {
+    int in = g->getInternalId(original);
+    return in >= 0 && g->findVertex(in) != nullptr;
+}
+
+/**
+ * @brief Starts the 2-opt of the early tour on the pool, so algorithm 6 finds it done or under way. It only runs if
+ * the load built an early tour and refineAfterLoad is set.
+ */
+void Menu::refineEarlyTour() {
+    refinedTour.clear();
+    if (earlyTour.empty() || !refineAfterLoad)
+        return;
+    refinement.run([this, tour = earlyTour]() mutable {
+        // a failure or a cancel only means algorithm 6 improves the early tour itself
+        try {
+            Management::improveTwoOpt(g, tour, TWO_OPT_TIME_LIMIT_MS, &stopRefinement);
+        } catch (const std::exception &) {
+            return;
+        }
+        if (!stopRefinement)
+            refinedTour = std::move(tour);
+    });
+}
+
+/**
+ * @brief Stops the 2-opt of the early tour, if it is still running, and waits for it to return. A tour it already
+ * finished is kept.
+ */
+void Menu::cancelRefinement() {
+    stopRefinement = true;
+    try {
+        refinement.wait();
+    } catch (const std::exception &) {}
+    stopRefinement = false;
+}
+
+/**
+ * @brief Sets the file the tours found are written to, in the TSPLIB format
+ * @param filename path of the .tour file, empty to not write tours
+ */
+void Menu::setTourOutput(const std::string &filename) {
+    tourOutputFile = filename;
+}
+
+/**
+ * @brief Name of the current dataset
+ */
+std::string Menu::datasetName() const {
+    return curDataset < 0 ? customDataset : datasets[curDataset];
+}
 
 /**
  * @brief This method is called to start the interface.
@@ -38,13 +149,48 @@ void Menu::clearOutputFile() {
  * @brief Prints the main menu.
  */
 void Menu::printMainMenu() {
+    // a load that finished while the user was in another screen is taken over without waiting
+    if (loader != nullptr && loader->isReady())
+        waitForGraph();
     system("clear");
+    std::ostringstream status;
+    std::vector<int> firstRoute;
+    if (loader != nullptr) {
+        status << "loading: " << loader->getProgress().describe();
+        if (loader->pollEarlyTour(firstRoute) && !firstRoute.empty())
+            status << ", first route of " << firstRoute.size() << " stops ready after " << loader->getEarlyTourMs()
+                   << "ms";
+    } else if (g != nullptr) {
+        MemoryUsage usage = g->getMemoryUsage();
+        LoadOptions loadOptions = Auxiliar::getLoadOptions();
+        status << g->getNumVertex() << " vertices, " << Memory::format(usage.total()) << " in the graph, peak RSS "
+               << Memory::format(Memory::peakRSS());
+        if (loadOptions.reorder != Curve::None)
+            status << ", " << SpaceFillingCurve::name(loadOptions.reorder) << " order";
+        if (g->isTiled())
+            status << ", tiled matrix";
+    }
+    if (!loadError.empty()) {
+        std::cout << loadError << "\n\n";
+        loadError.clear();
+    }
     std::cout << center("ROUTING ALGORITHM FOR OCEAN SHIPPING AND URBAN DELIVERIES", '*', MENU_WIDTH) << "\n\n"
-              << "0 - Choose dataset (current: " << datasets[curDataset] << ")" << "\n"
+              << "0 - Choose dataset (current: " << datasetName() << ")" << "\n"
+              << "    " << status.str() << "\n"
               << "\t1 - Backtracking algorithm" << "\n"
               << "\t2 - Triangular Approximation Heuristic" << "\n"
               << "\t3 - Other Heuristics" << "\n"
-              << "\t4 - In the Real World" << "\n\n";
+              << "\t4 - In the Real World" << "\n"
+              << "\t5 - Space-Filling Curve Heuristic" << "\n"
+              << "\t6 - Space-Filling Curve Heuristic improved with 2-opt" << "\n"
+              << "\t7 - Greedy Edge Heuristic" << "\n"
+              << "\t8 - Clarke-Wright Savings Heuristic" << "\n"
+              << "\t9 - Genetic Algorithm" << "\n"
+              << "\t10 - Ant Colony Optimisation" << "\n"
+              << "\t11 - Simulated Annealing" << "\n"
+              << "\t12 - Portfolio: the solvers suited to the graph, racing under one deadline" << "\n\n"
+              << "13 - Threads (current: " << ThreadPool::global().getNumThreads()
+              << (ThreadPool::global().isPinned() ? ", pinned" : "") << ")" << "\n\n";
 
     printExit();
     std::cout << "Press the number corresponding the action you want." << "\n";
@@ -62,59 +208,40 @@ void Menu::waitMenu(){
     system("clear");
     printingOptions options;
     switch (stoi(choice)) {
-        // Choose dataset
+        // Choose dataset: a load still running is cancelled and the new one runs in the background
         case 0: {
-            chooseDataset();
-            g = new Graph();
-            Auxiliar::readDataset(g, curDataset);
+            loader.reset();
+            if (!chooseDataset())
+                return;
+            loader = std::make_unique<DatasetLoader>(DatasetLoader::dataset(curDataset));
             printMainMenu();
             break;
         }
-        // Backtracking algorithm
-        case 1: {
-            auto start = std::chrono::high_resolution_clock::now();
-            double cost = Management::tspBacktracking(g);
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-
-            options.message = "TSP using a Backtracking Algorithm\n - For graph: " + datasets[curDataset] + ", starting in node 0";
-            printTspResults(options, cost, duration);
-            break;
-        }
-        // Triangular Approximation Heuristic
-        case 2: {
-            auto start = std::chrono::high_resolution_clock::now();
-            double cost = Management::tspTriangular(g);
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-
-            options.message = "TSP using the Triangular Approximation Algorithm\n - For graph: " + datasets[curDataset] + ", starting in node 0";
-            printTspResults(options, cost, duration);
-            break;
-        }
-        // Other Heuristics
-        case 3: {
-            auto start = std::chrono::high_resolution_clock::now();
-            double cost = Management::tspOther(g);
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-
-            options.message = "TSP using Other Heuristics\n - For graph: " + datasets[curDataset] + ", starting in node 0";
-            printTspResults(options, cost, duration);
+        // Backtracking algorithm and the heuristics
+        case 1:
+        case 2:
+        case 3:
+        case 5:
+        case 6:
+        case 7:
+        case 8:
+        case 9:
+        case 10:
+        case 11:
+        case 12: {
+            runAlgorithm(stoi(choice), 0, options);
             break;
         }
         // In the Real World
         case 4: {
             int startingPoint = chooseStartingPoint();
-
-            auto start = std::chrono::high_resolution_clock::now();
-            double cost = Management::tspRealWorld(g, startingPoint);
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-
-            options.message = "TSP in the Real World\n - For graph: " + datasets[curDataset] + ", starting in node " +
-                              std::to_string(startingPoint);
-            printTspResults(options, cost, duration);
+            runAlgorithm(4, startingPoint, options);
+            break;
+        }
+        // Threads of the pool shared by the loads and the solvers
+        case 13: {
+            chooseThreads();
+            printMainMenu();
             break;
         }
 
@@ -125,9 +252,284 @@ void Menu::waitMenu(){
 }
 
 /**
- * @brief Prints the list of datasets available and sets the current database to the one chosen by the user
+ * @brief Runs one of the TSP algorithms on the current graph and prints its results.
+ * @param algorithm Number of the algorithm in the main menu (1 to 12)
+ * @param startingPoint Starting point of the tour, only used by the real world algorithm
+ * @param options Printing options
  */
-void Menu::chooseDataset() {
+void Menu::runAlgorithm(int algorithm, int startingPoint, printingOptions options) {
+    std::string names[13] = {
+        "",
+        "TSP using a Backtracking Algorithm",
+        "TSP using the Triangular Approximation Algorithm",
+        "TSP using Other Heuristics",
+        "TSP in the Real World",
+        "TSP using the Space-Filling Curve Heuristic",
+        "TSP using the Space-Filling Curve Heuristic and 2-opt",
+        "TSP using the Greedy Edge Heuristic",
+        "TSP using the Clarke-Wright Savings Heuristic",
+        "TSP using a Genetic Algorithm",
+        "TSP using Ant Colony Optimisation",
+        "TSP using Simulated Annealing",
+        "TSP using a Portfolio of Solvers"
+    };
+    if (algorithm < 1 || algorithm > 12)
+        return;
+    if (!waitForGraph()) {
+        std::cout << (loadError.empty() ? "No dataset is loaded." : loadError) << "\n";
+        loadError.clear();
+        if (options.showEndMenu) {
+            endDisplayMenu();
+            getInput();
+        }
+        return;
+    }
+    if (algorithm != 4)
+        startingPoint = 0;
+    else if (!hasNode(startingPoint)) {
+        std::cout << "Node " << startingPoint << " is not in the graph.\n";
+        if (options.showEndMenu) {
+            endDisplayMenu();
+            getInput();
+        }
+        return;
+    }
+
+    options.message = names[algorithm] + "\n - For graph: " + datasetName() + ", starting in node " +
+                      std::to_string(startingPoint);
+
+    size_t estimate = estimateScratch(algorithm);
+    if (!Memory::fits(estimate)) {
+        std::ostringstream oss;
+        oss << options.message << "\n\nNot enough memory: the algorithm needs about " << Memory::format(estimate)
+            << " on top of the " << Memory::format(Memory::currentRSS()) << " in use, but the limit is "
+            << Memory::format(Memory::getLimit()) << ".\n";
+        std::cout << oss.str();
+        if (options.showEndMenu) {
+            endDisplayMenu();
+            getInput();
+        }
+        return;
+    }
+
+    // the 2-opt of the early tour is only read by algorithm 6, and would share the pool and the counters of any other
+    if (algorithm != 6)
+        cancelRefinement();
+
+    Memory::resetScratch();
+    StatsSnapshot before = Stats::collect();
+    auto start = std::chrono::high_resolution_clock::now();
+    double cost = 0;
+    // the backtracking and real world algorithms only report the cost
+    std::vector<int> tour;
+    // the time-bounded algorithms find different tours with different limits
+    std::string params;
+    switch (algorithm) {
+        case 6: params = "time=" + std::to_string(TWO_OPT_TIME_LIMIT_MS); break;
+        case 9: params = "time=" + std::to_string(GENETIC_TIME_LIMIT_MS); break;
+        case 10: params = "time=" + std::to_string(ANT_COLONY_TIME_LIMIT_MS); break;
+        case 11: params = "time=" + std::to_string(ANNEALING_TIME_LIMIT_MS); break;
+        case 12: params = "time=" + std::to_string(PORTFOLIO_TIME_LIMIT_MS); break;
+    }
+    CachedResult cached;
+    bool hit = ResultCache::find(checksum, algorithm, params, startingPoint, cached);
+    if (hit) {
+        tour = g->toInternalIds(cached.tour);
+        hit = tour.size() == cached.tour.size();
+    }
+    // the best tour found before by any algorithm is where the local searches start from
+    std::vector<int> warmStart;
+    if (!hit && ResultCache::bestTour(checksum, cached)) {
+        warmStart = g->toInternalIds(cached.tour);
+        if ((int) warmStart.size() != g->getNumVertex())
+            warmStart.clear();
+    }
+    if (hit) {
+        cost = cached.cost;
+        auto found = std::chrono::high_resolution_clock::now();
+        options.details = "Cached result: found in " +
+                          std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(found - start).count()) +
+                          "us\n";
+    } else {
+        switch (algorithm) {
+            case 1: cost = Management::tspBacktracking(g); break;
+            case 2: cost = Management::tspTriangular(g, &tour); break;
+            case 3: cost = Management::tspOther(g, &tour); break;
+            case 4: cost = Management::tspRealWorld(g, g->getInternalId(startingPoint)); break;
+            // the curve tour built while the dataset loaded is the same one, so it is reused when there is one
+            case 5: {
+                tour = earlyTour;
+                if (tour.empty())
+                    cost = Management::tspSpaceFillingCurve(g, &tour);
+                else
+                    cost = Management::tourCost(g, tour);
+                break;
+            }
+            // the 2-opt of the early tour started when the load finished, so it is usually done by now
+            case 6: {
+                refinement.wait();
+                tour = refinedTour.empty() ? earlyTour : refinedTour;
+                if (tour.empty())
+                    Management::tspSpaceFillingCurve(g, &tour);
+                if (!warmStart.empty() && Management::tourCost(g, warmStart) < Management::tourCost(g, tour)) {
+                    tour = warmStart;
+                    options.details = "Started from a cached tour\n";
+                } else if (!refinedTour.empty()) {
+                    cost = Management::tourCost(g, tour);
+                    options.details = "Improved in the background since the load finished\n";
+                    break;
+                }
+                cost = Management::improveTwoOpt(g, tour, TWO_OPT_TIME_LIMIT_MS);
+                break;
+            }
+            case 7: cost = Management::tspGreedyEdge(g, &tour); break;
+            case 8: cost = Management::tspSavings(g, &tour); break;
+            case 9: {
+                GeneticOptions geneticOptions;
+                geneticOptions.timeLimitMs = GENETIC_TIME_LIMIT_MS;
+                geneticOptions.initialTour = warmStart;
+                GeneticSearch search(g, geneticOptions);
+                cost = search.run();
+                tour = search.getBestTour();
+                std::ostringstream oss;
+                if (!warmStart.empty())
+                    oss << "Started from a cached tour\n";
+                oss << "Generations: " << search.getGenerations() << " (" << std::fixed << std::setprecision(1)
+                    << search.getGenerationsPerSecondPerCore() << " per second per core)\n";
+                options.details = oss.str();
+                break;
+            }
+            case 10: {
+                AntColonyOptions colonyOptions;
+                colonyOptions.timeLimitMs = ANT_COLONY_TIME_LIMIT_MS;
+                AntColony colony(g, colonyOptions);
+                cost = colony.run();
+                tour = colony.getBestTour();
+                options.details = "Iterations: " + std::to_string(colony.getIterations()) + "\n";
+                break;
+            }
+            case 11: {
+                AnnealingOptions annealingOptions;
+                annealingOptions.timeLimitMs = ANNEALING_TIME_LIMIT_MS;
+                annealingOptions.initialTour = warmStart;
+                SimulatedAnnealing annealing(g, annealingOptions);
+                cost = annealing.run();
+                tour = annealing.getBestTour();
+                options.details = std::string(warmStart.empty() ? "" : "Started from a cached tour\n") +
+                                  "Moves: " + std::to_string(annealing.getMoves()) + " tried, " +
+                                  std::to_string(annealing.getAccepted()) + " accepted\n";
+                break;
+            }
+            case 12: {
+                PortfolioOptions portfolioOptions;
+                portfolioOptions.timeLimitMs = PORTFOLIO_TIME_LIMIT_MS;
+                Portfolio portfolio(g, portfolioOptions);
+                cost = portfolio.run();
+                tour = portfolio.getBestTour();
+                std::ostringstream oss;
+                oss << "Solvers:";
+                for (const std::string &engine : portfolio.getEngines())
+                    oss << (engine == portfolio.getEngines().front() ? " " : ", ") << engine;
+                oss << "\nBest tour by: " << (tour.empty() ? "none" : portfolio.getWinner())
+                    << (portfolio.isOptimal() ? ", proved optimal" : "") << "\n";
+                options.details = oss.str();
+                break;
+            }
+        }
+        ResultCache::store(checksum, CachedResult{algorithm, params, startingPoint, cost, g->toOriginalIds(tour)});
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    if (!hit && (algorithm == 5 || algorithm == 6) && !earlyTour.empty() && earlyTourMs >= 0)
+        options.details += "First route: " + std::to_string(earlyTourMs) + "ms into the load, which took " +
+                           std::to_string(loadMs) + "ms\n";
+
+    MemoryUsage memory = g->getMemoryUsage();
+    memory.scratch = Memory::peakScratch();
+    StatsSnapshot stats = Stats::collect() - before;
+
+    if (!tourOutputFile.empty() && !tour.empty()) {
+        try {
+            Auxiliar::writeTour(g, tourOutputFile, datasetName() + " - " + names[algorithm], tour);
+        } catch (const std::runtime_error &e) {
+            options.details += std::string(e.what()) + "\n";
+        }
+    }
+
+    // computed once per dataset, outside the measured run; the tour just found is the upper bound, so the bound costs
+    // nothing but its own time limit
+    if (lowerBound < 0 && !tour.empty())
+        lowerBound = LowerBound::heldKarp(g, Management::tourCost(g, tour), LOWER_BOUND_TIME_LIMIT_MS);
+    printTspResults(options, cost, duration, stats, memory, lowerBound);
+}
+
+/**
+ * @brief Estimates the scratch memory an algorithm needs on the current graph
+ * @param algorithm Number of the algorithm in the main menu (1 to 12)
+ * @return bytes
+ */
+size_t Menu::estimateScratch(int algorithm) {
+    size_t n = g->getNumVertex();
+    size_t threads = ThreadPool::global().getNumThreads();
+    // greedy edge: a scanned row per thread, k candidates per vertex and their sorted edges, links and union-find
+    size_t greedy = n * (threads * sizeof(std::pair<double, int>) + 10 * (sizeof(int) + 2 * 16) + 8 * sizeof(int));
+    switch (algorithm) {
+        // one recursion frame per vertex in the path
+        case 1: return n * 64;
+        // Prim's keys, parents, infos and tree flags, plus the preorder path
+        case 2: return n * (2 * sizeof(int) + sizeof(double) + 1) + n * sizeof(Vertex *);
+        case 3: return n * sizeof(int);
+        // one recursion frame per vertex in the path, plus the path itself
+        case 4: return n * (64 + sizeof(int));
+        // coordinates, sort entries, permutation and tour
+        case 5:
+        case 6: return n * (2 * sizeof(double) + sizeof(std::pair<uint64_t, int>) + 2 * sizeof(int));
+        case 7:
+        case 8: return greedy;
+        // candidate lists, plus one population of tours per island
+        case 9: return n * (10 * sizeof(int) + (threads * 25 + 4) * sizeof(int));
+        // pheromone matrix of floats, candidate lists and their weights, and the tours of the ants
+        case 10: return n * (n * sizeof(float) + 15 * (sizeof(int) + sizeof(double)) + 64 * (sizeof(int) + 1));
+        // greedy edge seed, plus one tour per chain
+        case 11: return greedy + n * std::max<size_t>(4, threads) * sizeof(int);
+        // the solvers of the portfolio run at the same time
+        case 12: {
+            size_t total = estimateScratch(2) + 2 * greedy + estimateScratch(9) + estimateScratch(11);
+            return n <= 2000 ? total + estimateScratch(10) : total;
+        }
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Runs a single algorithm without the interactive menu and prints its results to the console and the output file.
+ * @param algorithm Number of the algorithm in the main menu (1 to 12)
+ * @param startingPoint Starting point of the tour, only used by the real world algorithm
+ * @return false if the dataset could not be loaded
+ */
+bool Menu::runBatch(int algorithm, int startingPoint) {
+    printingOptions options;
+    options.clear = false;
+    options.showEndMenu = false;
+    refineAfterLoad = algorithm == 6;
+    if (!waitForGraph()) {
+        std::cerr << loadError << "\n";
+        return false;
+    }
+    if (algorithm == 4 && !hasNode(startingPoint)) {
+        std::cerr << "Node " << startingPoint << " is not in the graph\n";
+        return false;
+    }
+    runAlgorithm(algorithm, startingPoint, options);
+    return true;
+}
+
+/**
+ * @brief Prints the list of datasets available and sets the current database to the one chosen by the user, asking
+ * again until the answer is one of them
+ * @return false if the input ended first, leaving the current dataset as it was
+ */
+bool Menu::chooseDataset() {
     std::cout << "Choose what dataset to use:\n\n";
     std::cout << "\tToy Graphs\n";
     std::cout << "\t\t0 - Shipping\n";
@@ -150,7 +552,16 @@ void Menu::chooseDataset() {
     std::cout << "\t\t15 - Graph 1\n";
     std::cout << "\t\t16 - Graph 2\n";
     std::cout << "\t\t17 - Graph 3\n\n";
-    std::cin >> curDataset;
+    int chosen;
+    while (!(std::cin >> chosen) || chosen < 0 || chosen >= Auxiliar::NUM_DATASETS) {
+        if (std::cin.eof())
+            return false;
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Choose a number between 0 and " << Auxiliar::NUM_DATASETS - 1 << ": ";
+    }
+    curDataset = chosen;
+    return true;
 }
 
 /**
@@ -164,14 +575,40 @@ int Menu::chooseStartingPoint() {
     return startingPoint;
 }
 
+/**
+ * @brief Sets the number of threads of the pool, once the dataset being loaded, which runs on it, is ready
+ */
+void Menu::chooseThreads() {
+    int threads;
+    std::cout << "Choose the number of threads (0 for one per hardware thread): ";
+    while (!(std::cin >> threads) || threads < 0 || threads > ThreadPool::MAX_THREADS) {
+        if (std::cin.eof())
+            return;
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Choose a number between 0 and " << ThreadPool::MAX_THREADS << ": ";
+    }
+    waitForGraph();
+    // the 2-opt of the early tour runs on the pool, which must be idle to be resized
+    cancelRefinement();
+    ThreadPool::configureGlobal(threads, ThreadPool::global().isPinned());
+    // a 2-opt cut short starts over on the new pool
+    if (refinedTour.empty())
+        refineEarlyTour();
+}
+
 
 /**
  * @brief Prints the results of the executed TSP algorithm
  * @param options Printing options
  * @param cost Cost of the tour
  * @param duration Execution time of the algorithm
+ * @param stats Instrumentation counters recorded by the algorithm
+ * @param memory Memory held by the graph and by the algorithm
+ * @param bound Lower bound on the optimal cost, used to report how far the tour can be from the optimum
  */
-void Menu::printTspResults(printingOptions options, double cost, long duration) {
+void Menu::printTspResults(printingOptions options, double cost, long duration, const StatsSnapshot &stats,
+                           const MemoryUsage &memory, double bound) {
     std::ostringstream oss;
 
     if (options.clear)
@@ -182,7 +619,19 @@ void Menu::printTspResults(printingOptions options, double cost, long duration)
     oss << "\n\n";
 
     oss << "Cost: " << cost << "\n";
+    double gap = LowerBound::gap(cost, bound);
+    if (cost > 0 && cost != INF && gap >= 0)
+        oss << "Lower bound: " << bound << " (gap " << std::fixed << std::setprecision(2) << gap << "%)"
+            << std::defaultfloat << std::setprecision(6) << "\n";
     oss << "Execution time: " << duration << "ms\n";
+    oss << options.details;
+
+    if (Stats::enabled()) {
+        oss << "\nDataset load:\n" << Stats::report(loadStats);
+        oss << "Algorithm:\n" << Stats::report(stats);
+    }
+
+    oss << "\nMemory:\n" << Memory::report(memory);
 
     std::cout << oss.str();
 
@@ -193,10 +642,10 @@ void Menu::printTspResults(printingOptions options, double cost, long duration)
         ofs.close();
     }
 
-    if (options.showEndMenu)
+    if (options.showEndMenu) {
         endDisplayMenu();
-
-    getInput();
+        getInput();
+    }
 }
 
 
@@ -1,10 +1,14 @@
 #ifndef PROJECT2_MENU_H
 #define PROJECT2_MENU_H
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "Graph.h"
+#include "Stats.h"
+#include "DatasetLoader.h"
 
 
 /**
@@ -12,6 +16,7 @@
  */
 struct printingOptions {
     std::string message;
+    std::string details;
     bool clear = true;
     bool printMessage = true;
     bool outputToFile = true;
@@ -25,9 +30,46 @@ struct printingOptions {
 class Menu {
 private:
     /**
-     * @brief Graph containing all of the chosen dataset information that is being managed.
+     * @brief Graph containing all of the chosen dataset information that is being managed, nullptr until the first
+     * load finishes.
      */
-    Graph *g;
+    Graph *g = nullptr;
+
+    /**
+     * @brief Load of the chosen dataset while it runs in the background, nullptr once its graph was taken over
+     */
+    std::unique_ptr<DatasetLoader> loader;
+
+    /**
+     * @brief Error of the last load that failed, shown once in the main menu
+     */
+    std::string loadError;
+
+    /**
+     * @brief Space-filling curve tour of the current graph built while it loaded, empty if it has no coordinates
+     */
+    std::vector<int> earlyTour;
+
+    /**
+     * @brief Time into the load at which the early tour was ready, and time the whole load took
+     */
+    long earlyTourMs = -1;
+    long loadMs = 0;
+
+    /**
+     * @brief 2-opt of the early tour, started on the pool as soon as the load finishes, and the tour it gives, empty
+     * until it is done, if there is no early tour or if it was cancelled. It only reads the graph, which is not deleted
+     * before it ends. It only starts if refineAfterLoad is set: in the menu, or for algorithm 6 in batch mode.
+     */
+    TaskGroup refinement;
+    std::atomic<bool> stopRefinement{false};
+    std::vector<int> refinedTour;
+    bool refineAfterLoad = true;
+
+    /**
+     * @brief Checksum of the files of the current graph, its key in the result cache, 0 when the cache is off
+     */
+    uint64_t checksum = 0;
 
     /**
      * @brief Contains the names of the datasets available.
@@ -54,10 +96,35 @@ private:
     };
 
     /**
-     * @brief Currently loaded dataset (index to dataset array)
+     * @brief Chosen dataset (index to dataset array), negative for a file given on the command line
      */
     int curDataset = 0;
 
+    /**
+     * @brief Dataset held by g, which curDataset goes back to if loading the chosen one fails
+     */
+    int loadedDataset = 0;
+
+    /**
+     * @brief Name of the dataset when it is not one of the datasets array
+     */
+    std::string customDataset;
+
+    /**
+     * @brief Path the tour of every algorithm run is written to in the TSPLIB format, empty to not write it
+     */
+    std::string tourOutputFile;
+
+    /**
+     * @brief Instrumentation counters recorded while loading the current dataset
+     */
+    StatsSnapshot loadStats;
+
+    /**
+     * @brief Held-Karp lower bound of the current dataset, negative until the first algorithm runs on it
+     */
+    double lowerBound = -1;
+
     /**
      * @brief Path of the output file
      */
@@ -68,16 +135,50 @@ private:
      */
     const static int MENU_WIDTH = 86;
 
+    /**
+     * @brief Time given to the 2-opt improvement of the space-filling curve tour
+     */
+    const static long TWO_OPT_TIME_LIMIT_MS = 10000;
+
+    /**
+     * @brief Time given to the genetic algorithm
+     */
+    const static long GENETIC_TIME_LIMIT_MS = 10000;
+
+    /**
+     * @brief Time given to the ant colony optimisation
+     */
+    const static long ANT_COLONY_TIME_LIMIT_MS = 10000;
+
+    /**
+     * @brief Time given to the simulated annealing
+     */
+    const static long ANNEALING_TIME_LIMIT_MS = 10000;
+
+    /**
+     * @brief Deadline shared by the solvers of the portfolio
+     */
+    const static long PORTFOLIO_TIME_LIMIT_MS = 10000;
+
+    /**
+     * @brief Time given to the subgradient optimisation of the lower bound
+     */
+    const static long LOWER_BOUND_TIME_LIMIT_MS = 5000;
+
 public:
-    Menu(Graph *g);
+    Menu(std::unique_ptr<DatasetLoader> loader, int dataset = 0, const std::string &datasetName = "");
+    ~Menu();
+    void setTourOutput(const std::string &filename);
     void run();
+    bool runBatch(int algorithm, int startingPoint);
 
 private:
     // Wait for inputs
     void waitMenu();
     char getInput();
-    void chooseDataset();
+    bool chooseDataset();
     int chooseStartingPoint();
+    void chooseThreads();
 
     // Print menus
     void printMainMenu();
@@ -90,9 +191,21 @@ private:
 
     // Auxiliary formatting functions
     std::string center(const std::string &str, char sep, int width);
+    std::string datasetName() const;
+
+    // Loading datasets
+    bool waitForGraph();
+    void refineEarlyTour();
+    void cancelRefinement();
+
+    // Running algorithms
+    void runAlgorithm(int algorithm, int startingPoint, printingOptions options);
+    bool hasNode(int original) const;
+    size_t estimateScratch(int algorithm);
 
     // Printing
-    void printTspResults(printingOptions options, double cost, long duration);
+    void printTspResults(printingOptions options, double cost, long duration, const StatsSnapshot &stats,
+                         const MemoryUsage &memory, double bound);
 };
 
 
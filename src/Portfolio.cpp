@@ -0,0 +1,230 @@
+#include "Portfolio.h"
+#include "Graph.h"
+#include "Management.h"
+#include "ExactSearch.h"
+#include "GeneticSearch.h"
+#include "AntColony.h"
+#include "SimulatedAnnealing.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <memory>
+
+/**
+ * @brief Chooses the solvers for a graph
+ * @param graph graph to solve, its vertices must not change while the portfolio runs
+ * @param options deadline and size limits
+ */
+Portfolio::Portfolio(Graph *graph, const PortfolioOptions &options)
+        : graph(graph), options(options), bound(INF), bestCost(INF) {
+    choose();
+}
+
+/**
+ * @brief Picks the solvers from the number of vertices, the density of the edges and whether there are coordinates
+ * @details Time Complexity O(v) -> v: number of vertices
+ */
+void Portfolio::choose() {
+    auto vertices = graph->getVertexSet();
+    long n = vertices.size();
+    bool edgesComplete = (long) graph->getNumEdges() >= n * (n - 1);
+    bool coordinates = graph->getMetric() != Metric::Matrix ||
+                       std::any_of(vertices.begin(), vertices.end(), [](Vertex *v) {
+                           return v->getLat() != 0 || v->getLon() != 0;
+                       });
+    // sparse graphs with coordinates have the missing distances filled in at load time
+    bool distancesComplete = edgesComplete || coordinates;
+
+    // the heuristics that write to the vertices (MST and visited flags) take turns
+    auto vertexMutex = std::make_shared<std::mutex>();
+
+    if (distancesComplete) {
+        engines.push_back({"Greedy Edge", false, [this](long, std::vector<int> &tour) {
+            return Management::tspGreedyEdge(graph, &tour);
+        }});
+        engines.push_back({"Clarke-Wright Savings", false, [this](long, std::vector<int> &tour) {
+            return Management::tspSavings(graph, &tour);
+        }});
+        if (n <= options.triangularMaxVertices) {
+            engines.push_back({"Triangular Approximation", false, [this, vertexMutex](long, std::vector<int> &tour) {
+                std::lock_guard<std::mutex> lock(*vertexMutex);
+                return Management::tspTriangular(graph, &tour);
+            }});
+        }
+        if (coordinates) {
+            engines.push_back({"Space-Filling Curve and 2-opt", false, [this](long timeLimitMs, std::vector<int> &tour) {
+                Management::tspSpaceFillingCurve(graph, &tour);
+                return Management::improveTwoOpt(graph, tour, std::max(1L, timeLimitMs));
+            }});
+        }
+    }
+
+    // the exact search follows the edges, so it only competes with the heuristics when every pair has one; without
+    // coordinates or every pair, it is the only solver that can, whatever the size
+    if ((edgesComplete && n <= options.exactMaxVertices) || !distancesComplete) {
+        int start = std::max(0, graph->findVertexIdx(graph->getInternalId(0)));
+        engines.push_back({"Branch and Bound", true, [this, start, edgesComplete](long timeLimitMs,
+                                                                                  std::vector<int> &tour) {
+            ExactSearch search(graph, start);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (edgesComplete && !bestTour.empty())
+                    search.setIncumbent(bestCost, bestTour);
+            }
+            search.share(edgesComplete ? &bound : nullptr, &stop);
+            search.setTimeLimit(std::max(1L, timeLimitMs));
+            double cost = search.run();
+            tour = search.getBestTour();
+            if (search.isComplete()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                optimal = true;
+                stop = true;
+            }
+            return tour.empty() ? INF : cost;
+        }});
+    }
+
+    if (distancesComplete && n >= 5) {
+        if (n <= options.geneticMaxVertices) {
+            engines.push_back({"Genetic Algorithm", true, [this, vertexMutex](long timeLimitMs, std::vector<int> &tour) {
+                GeneticOptions geneticOptions;
+                geneticOptions.timeLimitMs = timeLimitMs;
+                geneticOptions.stop = &stop;
+                std::unique_ptr<GeneticSearch> search;
+                {
+                    // the seed tours come from the triangular and nearest neighbour heuristics
+                    std::lock_guard<std::mutex> lock(*vertexMutex);
+                    search = std::make_unique<GeneticSearch>(graph, geneticOptions);
+                }
+                double cost = search->run();
+                tour = search->getBestTour();
+                return cost;
+            }});
+        }
+        engines.push_back({"Simulated Annealing", true, [this](long timeLimitMs, std::vector<int> &tour) {
+            AnnealingOptions annealingOptions;
+            annealingOptions.timeLimitMs = timeLimitMs;
+            annealingOptions.stop = &stop;
+            SimulatedAnnealing annealing(graph, annealingOptions);
+            double cost = annealing.run();
+            tour = annealing.getBestTour();
+            return cost;
+        }});
+        if (n <= options.antColonyMaxVertices) {
+            engines.push_back({"Ant Colony Optimisation", true, [this](long timeLimitMs, std::vector<int> &tour) {
+                AntColonyOptions colonyOptions;
+                colonyOptions.timeLimitMs = timeLimitMs;
+                colonyOptions.stop = &stop;
+                AntColony colony(graph, colonyOptions);
+                double cost = colony.run();
+                tour = colony.getBestTour();
+                return cost;
+            }});
+        }
+    }
+
+    for (const Engine &engine : engines)
+        timeBoundedLeft += engine.timeBounded;
+}
+
+/**
+ * @brief Runs the chosen solvers on the thread pool until they finish, the deadline passes or a tour is proved optimal
+ * @return Cost of the best tour found, INF if none was
+ * @details The constructive heuristics are queued first, so the time-bounded solvers start from their bound even when
+ * the pool runs them one after the other.
+ */
+double Portfolio::run() {
+    TRACE_SPAN("Portfolio", "solve");
+    deadline = Clock::now() + std::chrono::milliseconds(options.timeLimitMs);
+    TaskGroup group;
+    for (const Engine &engine : engines) {
+        group.run([this, &engine, &group]() {
+            // the constructive heuristics take little time and give the first tours, the others only start in time
+            if (stop || (engine.timeBounded && Clock::now() >= deadline))
+                return;
+            TRACE_SPAN("portfolio solver", "solve");
+            std::vector<int> tour;
+            double cost = engine.solve(budget(engine), tour);
+            offer(cost, std::move(tour), engine.name);
+            if (stop)
+                group.cancel();
+        });
+    }
+    group.wait();
+    return bestCost;
+}
+
+/**
+ * @brief Keeps a tour if it is the best so far, and lowers the bound the branch and bound prunes with
+ * @param cost cost of the tour
+ * @param tour vertex infos of the tour
+ * @param engine name of the solver that found it
+ */
+void Portfolio::offer(double cost, std::vector<int> &&tour, const std::string &engine) {
+    if (tour.empty() || cost >= INF)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cost >= bestCost)
+        return;
+    bestCost = cost;
+    bestTour = std::move(tour);
+    winner = engine;
+    double known = bound.load();
+    while (cost < known && !bound.compare_exchange_weak(known, cost));
+}
+
+/**
+ * @brief Time a solver may take: all that is left when there is a thread for every time-bounded solver, otherwise an
+ * equal part of it for each time-bounded solver that did not start yet
+ * @param engine solver about to start
+ * @return milliseconds
+ */
+long Portfolio::budget(const Engine &engine) {
+    long left = std::max<long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count());
+    if (!engine.timeBounded)
+        return left;
+    std::lock_guard<std::mutex> lock(budgetMutex);
+    int waiting = std::max(1, timeBoundedLeft--);
+    int total = 0;
+    for (const Engine &e : engines)
+        total += e.timeBounded;
+    if ((int) ThreadPool::global().getNumThreads() >= total)
+        return left;
+    return left / waiting;
+}
+
+/**
+ * @brief Best tour found by the last run
+ * @return vertex infos, starting at node 0 of the dataset, empty if no solver found a tour
+ */
+std::vector<int> Portfolio::getBestTour() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return bestTour;
+}
+
+/**
+ * @brief Name of the solver that found the best tour, empty if none did
+ */
+std::string Portfolio::getWinner() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return winner;
+}
+
+/**
+ * @brief Names of the solvers chosen for the graph, in the order they are started
+ */
+std::vector<std::string> Portfolio::getEngines() const {
+    std::vector<std::string> names;
+    for (const Engine &engine : engines)
+        names.push_back(engine.name);
+    return names;
+}
+
+/**
+ * @brief Whether the branch and bound searched its whole tree, so the best tour is optimal
+ */
+bool Portfolio::isOptimal() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return optimal;
+}
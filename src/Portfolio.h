@@ -0,0 +1,86 @@
+#ifndef PROJECT2_PORTFOLIO_H
+#define PROJECT2_PORTFOLIO_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Graph;
+
+/**
+ * @brief Parameters of the portfolio solver
+ */
+struct PortfolioOptions {
+    // deadline shared by every solver of the portfolio
+    long timeLimitMs = 10000;
+    // complete graphs up to this size also run the exact branch and bound
+    int exactMaxVertices = 64;
+    // the ant colony keeps a pheromone matrix, so it only runs up to this size
+    int antColonyMaxVertices = 2000;
+    // the triangular approximation takes O(v²) time whatever the deadline, so it only runs up to this size
+    int triangularMaxVertices = 20000;
+    // the genetic algorithm keeps populations of full tours, so it only runs up to this size
+    int geneticMaxVertices = 20000;
+};
+
+/**
+ * @brief Runs a set of solvers chosen from the size, the density and the coordinates of the graph at the same time on
+ * the thread pool, under one deadline, and keeps the best tour any of them found.
+ *
+ * Graphs whose edges connect every pair run the constructive heuristics, the metaheuristics and, when small enough,
+ * the exact branch and bound, which prunes with the cost of the best tour found by any of them. Sparse graphs with
+ * coordinates have their missing distances filled in, so they run the heuristics; sparse graphs without coordinates
+ * only have their edges, so only the branch and bound can follow them. When the branch and bound proves a tour
+ * optimal, the other solvers are stopped.
+ *
+ * Solvers whose time is bounded share the deadline: with a thread for each they all get the whole time, otherwise
+ * each gets an equal part of what is left when it starts.
+ */
+class Portfolio {
+public:
+    Portfolio(Graph *graph, const PortfolioOptions &options);
+
+    double run();
+    std::vector<int> getBestTour() const;
+    std::string getWinner() const;
+    std::vector<std::string> getEngines() const;
+    bool isOptimal() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Solver of the portfolio: solve gets the time it may take and returns the cost and the tour it found
+     */
+    struct Engine {
+        std::string name;
+        bool timeBounded;
+        std::function<double(long timeLimitMs, std::vector<int> &tour)> solve;
+    };
+
+    void choose();
+    void offer(double cost, std::vector<int> &&tour, const std::string &engine);
+    long budget(const Engine &engine);
+
+    Graph *graph;
+    PortfolioOptions options;
+    std::vector<Engine> engines;
+    Clock::time_point deadline;
+    int timeBoundedLeft = 0;
+    std::mutex budgetMutex;
+
+    // best cost known, read by the branch and bound to prune, and the flag that stops every solver
+    std::atomic<double> bound;
+    std::atomic<bool> stop{false};
+
+    mutable std::mutex mutex;
+    double bestCost;
+    std::vector<int> bestTour;
+    std::string winner;
+    bool optimal = false;
+};
+
+#endif //PROJECT2_PORTFOLIO_H
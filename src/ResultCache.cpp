@@ -0,0 +1,230 @@
+#include "ResultCache.h"
+#include "LittleEndian.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+std::string ResultCache::directory;
+std::mutex ResultCache::mutex;
+std::map<uint64_t, std::map<ResultCache::Key, CachedResult>> ResultCache::datasets;
+std::map<uint64_t, size_t> ResultCache::records;
+
+namespace {
+
+const char MAGIC[4] = {'T', 'S', 'P', 'C'};
+
+using LittleEndian::put;
+using LittleEndian::get;
+
+void putRecord(std::ostream &out, const CachedResult &result) {
+    put<int32_t>(out, result.algorithm);
+    put<int32_t>(out, result.start);
+    put<uint32_t>(out, result.params.size());
+    out.write(result.params.data(), result.params.size());
+    put<double>(out, result.cost);
+    put<uint32_t>(out, result.tour.size());
+    for (int id : result.tour)
+        put<int32_t>(out, id);
+}
+
+}
+
+/**
+ * @brief Turns the cache on, keeping its files in a directory, which is created if needed
+ * @param newDirectory cache directory, empty to turn the cache off
+ */
+void ResultCache::setDirectory(const std::string &newDirectory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    directory = newDirectory;
+    datasets.clear();
+    records.clear();
+    if (!directory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+    }
+}
+
+bool ResultCache::enabled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !directory.empty();
+}
+
+/**
+ * @brief 64-bit FNV-1a hash of the contents of the files, in order, so the same data gets the same key wherever it
+ * is stored
+ * @param files files of a dataset
+ * @param variant how the files were loaded, such as the load options, hashed after them so each way of loading the
+ * same files has results of its own; empty for none
+ * @return checksum, 0 if a file can not be read
+ * @details Time Complexity O(b) -> b: total size of the files
+ */
+uint64_t ResultCache::checksum(const std::vector<std::string> &files, const std::string &variant) {
+    uint64_t hash = 14695981039346656037ull;
+    std::vector<char> buf(1 << 16);
+    for (const std::string &file : files) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in)
+            return 0;
+        while (in) {
+            in.read(buf.data(), buf.size());
+            for (std::streamsize i = 0; i < in.gcount(); i++) {
+                hash ^= (unsigned char) buf[i];
+                hash *= 1099511628211ull;
+            }
+        }
+        // files with the same concatenation but split differently are different datasets
+        hash ^= 0xff;
+        hash *= 1099511628211ull;
+    }
+    for (char c : variant) {
+        hash ^= (unsigned char) c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Looks up the result of an earlier run with the same dataset, algorithm, parameters and start node
+ * @param result filled in if found
+ * @return true if found
+ * @details Time Complexity O(log r) once the dataset file was read -> r: results stored for the dataset
+ */
+bool ResultCache::find(uint64_t dataset, int algorithm, const std::string &params, int start, CachedResult &result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (directory.empty() || dataset == 0)
+        return false;
+    auto &results = load(dataset);
+    auto it = results.find(Key(algorithm, params, start));
+    if (it == results.end())
+        return false;
+    result = it->second;
+    return true;
+}
+
+/**
+ * @brief Cheapest tour stored for a dataset by any algorithm with any parameters, to warm-start a search
+ * @param result filled in if there is one
+ * @return true if there is a stored tour
+ * @details Time Complexity O(r) -> r: results stored for the dataset
+ */
+bool ResultCache::bestTour(uint64_t dataset, CachedResult &result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (directory.empty() || dataset == 0)
+        return false;
+    const CachedResult *best = nullptr;
+    for (auto &[key, r] : load(dataset)) {
+        if (!r.tour.empty() && (best == nullptr || r.cost < best->cost))
+            best = &r;
+    }
+    if (best == nullptr)
+        return false;
+    result = *best;
+    return true;
+}
+
+/**
+ * @brief Stores a result in memory and appends it to the file of the dataset, unless a result at least as cheap is
+ * already stored under the same key. The file is rewritten with only the current results once most of its records
+ * are outdated.
+ * @param dataset checksum of the dataset
+ * @param result result to store, with the tour in node ids of the dataset
+ * @details Time Complexity O(log r + v), O(r v) when the file is rewritten -> r: results stored for the dataset,
+ * v: number of vertices
+ */
+void ResultCache::store(uint64_t dataset, const CachedResult &result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (directory.empty() || dataset == 0)
+        return;
+    auto &results = load(dataset);
+    Key key(result.algorithm, result.params, result.start);
+    auto it = results.find(key);
+    // the time-bounded runs share one key, so only their best tour is kept
+    if (it != results.end() && it->second.cost <= result.cost && it->second.tour.size() >= result.tour.size())
+        return;
+    results[key] = result;
+
+    size_t &count = records[dataset];
+    if (count + 1 > 2 * results.size()) {
+        compact(dataset);
+        return;
+    }
+    bool exists = std::filesystem::exists(path(dataset));
+    std::ofstream out(path(dataset), std::ios::binary | std::ios::app);
+    if (!out)
+        return;
+    if (!exists)
+        out.write(MAGIC, sizeof(MAGIC));
+    putRecord(out, result);
+    count++;
+}
+
+/**
+ * @brief Rewrites the file of a dataset with one record per result held in memory. The new file is written next to
+ * the old one and renamed over it, so an interrupted rewrite leaves the old file.
+ * @details Time Complexity O(r v) -> r: results stored for the dataset, v: number of vertices
+ */
+void ResultCache::compact(uint64_t dataset) {
+    std::string file = path(dataset);
+    std::string temporary = file + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return;
+        out.write(MAGIC, sizeof(MAGIC));
+        for (auto &[key, r] : datasets[dataset])
+            putRecord(out, r);
+        if (!out)
+            return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, file, ec);
+    if (!ec)
+        records[dataset] = datasets[dataset].size();
+}
+
+/**
+ * @brief Results of a dataset, read from its file the first time. A truncated last record, left by a run that was
+ * interrupted while writing, is ignored.
+ */
+std::map<ResultCache::Key, CachedResult> &ResultCache::load(uint64_t dataset) {
+    auto found = datasets.find(dataset);
+    if (found != datasets.end())
+        return found->second;
+
+    auto &results = datasets[dataset];
+    std::ifstream in(path(dataset), std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), MAGIC))
+        return results;
+    while (true) {
+        CachedResult r;
+        int32_t algorithm, start;
+        uint32_t paramsSize, tourSize;
+        if (!get(in, algorithm) || !get(in, start) || !get(in, paramsSize))
+            break;
+        r.algorithm = algorithm;
+        r.start = start;
+        r.params.resize(paramsSize);
+        if (!in.read(r.params.data(), paramsSize) || !get(in, r.cost) || !get(in, tourSize))
+            break;
+        r.tour.resize(tourSize);
+        bool read = true;
+        for (uint32_t i = 0; i < tourSize && read; i++)
+            read = get(in, r.tour[i]);
+        if (!read)
+            break;
+        results[Key(r.algorithm, r.params, r.start)] = std::move(r);
+        records[dataset]++;
+    }
+    return results;
+}
+
+/**
+ * @brief File of a dataset in the cache directory
+ */
+std::string ResultCache::path(uint64_t dataset) {
+    std::ostringstream oss;
+    oss << std::hex << dataset;
+    return (std::filesystem::path(directory) / (oss.str() + ".bin")).string();
+}
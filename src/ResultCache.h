@@ -0,0 +1,62 @@
+#ifndef PROJECT2_RESULTCACHE_H
+#define PROJECT2_RESULTCACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/**
+ * @brief Result of a solver run stored in the cache. The tour holds the node ids of the dataset, so it stays valid
+ * whatever internal numbering a later load uses.
+ */
+struct CachedResult {
+    int algorithm = 0;
+    std::string params;
+    int start = 0;
+    double cost = 0;
+    std::vector<int> tour;
+};
+
+/**
+ * @brief On-disk cache of solver results, keyed by the checksum of the dataset files, the algorithm, its parameters and
+ * the start node. Each dataset has one binary file in the cache directory, to which results are appended; the file is
+ * read once per process and its results are then looked up in memory. A result only replaces a cheaper one, and the
+ * file is rewritten with the current results once most of its records are outdated, so it stays within twice their
+ * size.
+ *
+ * Record layout, every number written least significant byte first whatever the host: algorithm (int32), start
+ * (int32), parameter length (uint32), parameters (bytes), cost (float64), tour length (uint32), tour (int32 each).
+ * Later records with the same key replace earlier ones.
+ *
+ * Results found with other parameters are still useful as warm starts: bestTour gives the cheapest full tour known
+ * for the dataset.
+ */
+class ResultCache {
+public:
+    static void setDirectory(const std::string &directory);
+    static bool enabled();
+
+    static uint64_t checksum(const std::vector<std::string> &files, const std::string &variant = "");
+
+    static bool find(uint64_t dataset, int algorithm, const std::string &params, int start, CachedResult &result);
+    static bool bestTour(uint64_t dataset, CachedResult &result);
+    static void store(uint64_t dataset, const CachedResult &result);
+
+private:
+    using Key = std::tuple<int, std::string, int>;
+
+    static std::map<Key, CachedResult> &load(uint64_t dataset);
+    static void compact(uint64_t dataset);
+    static std::string path(uint64_t dataset);
+
+    static std::string directory;
+    static std::mutex mutex;
+    static std::map<uint64_t, std::map<Key, CachedResult>> datasets;
+    // records in the file of each dataset, outdated ones included
+    static std::map<uint64_t, size_t> records;
+};
+
+#endif //PROJECT2_RESULTCACHE_H
@@ -0,0 +1,741 @@
+#include "Server.h"
+#include "Management.h"
+#include "GeneticSearch.h"
+#include "AntColony.h"
+#include "SimulatedAnnealing.h"
+#include "ResultCache.h"
+#include "Portfolio.h"
+#include "Auxiliar.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Splits the threads of the global pool between the request workers and the pool, which is shrunk to the
+ * threads left over, so the solves running at once and their parallel parts never use more threads than it had
+ * @param requested request workers asked for, 0 for half the threads
+ * @return number of request workers
+ */
+unsigned shareThreads(int requested) {
+    ThreadPool &pool = ThreadPool::global();
+    unsigned total = pool.getNumThreads();
+    unsigned workers = requested > 0 ? (unsigned) requested : std::max(1u, total / 2);
+    // each request worker takes part in the parallel parts of its solve as the calling thread, so the pool keeps one
+    // worker per thread beyond the request workers
+    ThreadPool::configureGlobal(total > workers ? total - workers + 1 : 1, pool.isPinned());
+    return workers;
+}
+
+}
+
+/**
+ * @brief Starts the workers, taking their threads from the global pool; nothing is loaded until a request asks for it
+ * @param options parameters of the server
+ */
+Server::Server(const ServerOptions &options)
+        : options(options), workers(shareThreads(options.workers)) {}
+
+/**
+ * @brief Waits for the requests still queued, then closes the socket
+ */
+Server::~Server() {
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        idle.wait(lock, [this]() { return pending == 0; });
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(options.socketPath.c_str());
+    }
+}
+
+/**
+ * @brief Serves until shutdown is requested, or until stdin ends when there is no socket
+ * @return 0, or 1 if the socket could not be opened
+ */
+int Server::run() {
+    if (options.socketPath.empty()) {
+        auto connection = std::make_shared<Connection>();
+        connection->in = STDIN_FILENO;
+        connection->out = STDOUT_FILENO;
+        serve(connection);
+        std::unique_lock<std::mutex> lock(queueMutex);
+        idle.wait(lock, [this]() { return pending == 0; });
+        return 0;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof(address.sun_path))
+        return 1;
+    options.socketPath.copy(address.sun_path, options.socketPath.size());
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(options.socketPath.c_str());
+    if (listenFd < 0 || bind(listenFd, (sockaddr *) &address, sizeof(address)) < 0 || listen(listenFd, 64) < 0)
+        return 1;
+
+    while (!stopping) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+        reapSessions();
+        auto connection = std::make_shared<Connection>();
+        connection->in = fd;
+        connection->out = fd;
+        Session session;
+        session.connection = connection;
+        session.finished = std::make_shared<std::atomic<bool>>(false);
+        session.thread = std::thread([this, connection, finished = session.finished]() mutable {
+            serve(std::move(connection));
+            *finished = true;
+        });
+        sessions.push_back(std::move(session));
+    }
+
+    // answer what is queued, then wake the sessions still waiting for requests
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        idle.wait(lock, [this]() { return pending == 0; });
+    }
+    for (auto &session : sessions) {
+        if (auto connection = session.connection.lock())
+            ::shutdown(connection->in, SHUT_RDWR);
+    }
+    for (auto &session : sessions)
+        session.thread.join();
+    sessions.clear();
+    return 0;
+}
+
+/**
+ * @brief Joins the threads of the connections that ended, so a long-running server does not keep one per client
+ * @details Time Complexity O(s) -> s: number of sessions
+ */
+void Server::reapSessions() {
+    auto done = std::remove_if(sessions.begin(), sessions.end(), [](Session &session) {
+        if (!*session.finished)
+            return false;
+        session.thread.join();
+        return true;
+    });
+    sessions.erase(done, sessions.end());
+}
+
+/**
+ * @brief Reads the requests of one connection line by line until it ends or asks to quit
+ * @param connection connection to read from
+ */
+void Server::serve(std::shared_ptr<Connection> connection) {
+    std::string buffer;
+    char chunk[4096];
+    while (true) {
+        size_t newline;
+        while ((newline = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!handleLine(line, connection))
+                return;
+        }
+        ssize_t got = read(connection->in, chunk, sizeof(chunk));
+        if (got <= 0)
+            return;
+        buffer.append(chunk, got);
+    }
+}
+
+/**
+ * @brief Answers the commands that need no work at once and queues the others
+ * @param line request line
+ * @param connection connection the answer goes to
+ * @return false if the connection is done
+ */
+bool Server::handleLine(const std::string &line, const std::shared_ptr<Connection> &connection) {
+    std::istringstream ss(line);
+    Request request;
+    if (!(ss >> request.command))
+        return true;
+    std::string token;
+    while (ss >> token) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos)
+            request.args[token] = "";
+        else
+            request.args[token.substr(0, eq)] = token.substr(eq + 1);
+    }
+    request.id = request.args.count("id") ? request.args["id"] : "";
+    request.connection = connection;
+
+    if (request.command == "ping") {
+        connection->send(answer(request.id, "ok"));
+        return true;
+    }
+    if (request.command == "quit")
+        return false;
+    if (request.command == "shutdown") {
+        connection->send(answer(request.id, "ok"));
+        stopping = true;
+        if (listenFd >= 0)
+            ::shutdown(listenFd, SHUT_RDWR);
+        return false;
+    }
+
+    long deadlineMs = options.defaultDeadlineMs;
+    try {
+        if (request.args.count("deadline"))
+            deadlineMs = std::stol(request.args["deadline"]);
+    } catch (const std::exception &) {
+        connection->send(answer(request.id, "error", "\"error\":\"deadline is not a number\""));
+        return true;
+    }
+    request.received = Clock::now();
+    request.deadline = request.received + std::chrono::milliseconds(deadlineMs);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push(std::move(request));
+        pending++;
+    }
+    // each task runs whichever request is most urgent when a worker gets to it
+    workers.submit([this]() { runNext(); });
+    return true;
+}
+
+/**
+ * @brief Earliest deadline first: the request with the later deadline is the smaller one in the queue
+ */
+bool Server::Request::operator<(const Request &other) const {
+    return deadline > other.deadline;
+}
+
+/**
+ * @brief Takes the queued request with the earliest deadline, runs it and sends its answer
+ */
+void Server::runNext() {
+    Request request;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        request = queue.top();
+        queue.pop();
+    }
+    std::string line;
+    try {
+        line = execute(request);
+    } catch (const std::exception &e) {
+        line = answer(request.id, "error", "\"error\":" + quote(e.what()));
+    }
+    request.connection->send(line);
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (--pending == 0)
+        idle.notify_all();
+}
+
+/**
+ * @brief Runs a queued request
+ * @return answer line
+ * @throws std::runtime_error if the request is not valid or its dataset can not be loaded
+ */
+std::string Server::execute(const Request &request) {
+    if (Clock::now() >= request.deadline)
+        return answer(request.id, "expired");
+
+    if (request.command == "unload") {
+        unload(request.args);
+        return answer(request.id, "ok");
+    }
+    bool change = request.command == "insert" || request.command == "remove" || request.command == "weight" ||
+                  request.command == "batch";
+    if (request.command != "load" && request.command != "solve" && !change)
+        throw std::runtime_error("unknown command " + request.command);
+
+    std::shared_ptr<Resident> r = resident(request.args, true);
+    Graph *g;
+    try {
+        g = r->loader->getFuture().get();
+    } catch (const std::runtime_error &) {
+        // forget the failed load so a later request tries again
+        unload(request.args);
+        throw;
+    }
+    if (request.command == "load")
+        return answer(request.id, "ok", "\"vertices\":" + std::to_string(g->getNumVertex()) +
+                                        ",\"load_ms\":" + std::to_string(r->loader->getLoadMs()));
+    if (change)
+        return update(request, r);
+    return solve(request, r);
+}
+
+/**
+ * @brief Runs a solve request on a loaded graph
+ * @return answer line with the cost, the times and the tour
+ */
+std::string Server::solve(const Request &request, const std::shared_ptr<Resident> &resident) {
+    Graph *g = resident->loader->getFuture().get();
+    auto arg = [&](const std::string &key, int fallback) {
+        auto it = request.args.find(key);
+        return it == request.args.end() ? fallback : std::stoi(it->second);
+    };
+    int algorithm = arg("algorithm", 0);
+    int start = arg("start", 0);
+    if (algorithm < 1 || algorithm > 12)
+        throw std::runtime_error("algorithm must be between 1 and 12");
+
+    // changes of the graph wait for the solves running on it
+    std::shared_lock<std::shared_mutex> graphLock(resident->graphMutex);
+    if (algorithm == 4) {
+        int in = g->getInternalId(start);
+        if (in < 0 || g->findVertex(in) == nullptr)
+            throw std::runtime_error("node " + std::to_string(start) + " is not in the graph");
+    }
+    auto begin = Clock::now();
+    long timeLimitMs = std::max<long>(1, std::chrono::duration_cast<std::chrono::milliseconds>(
+            request.deadline - begin).count());
+    double cost = 0;
+    std::vector<int> tour;
+    // a changed graph no longer matches the files its checksum was taken from
+    uint64_t checksum = resident->modified ? 0 : resident->loader->getChecksum();
+    // the time-bounded algorithms get the time left before the deadline, so their results are only kept as warm starts,
+    // all under one key that holds the best tour found under any deadline
+    bool timeBounded = algorithm == 6 || algorithm >= 9;
+    std::string params = timeBounded ? "deadline" : "";
+    CachedResult cached;
+    bool hit = !timeBounded && ResultCache::find(checksum, algorithm, params, start, cached);
+    if (hit) {
+        tour = g->toInternalIds(cached.tour);
+        hit = tour.size() == cached.tour.size();
+    }
+    // solver of the portfolio that found the tour
+    std::string engine;
+    std::vector<int> warmStart;
+    if (timeBounded && ResultCache::bestTour(checksum, cached)) {
+        warmStart = g->toInternalIds(cached.tour);
+        if ((int) warmStart.size() != g->getNumVertex())
+            warmStart.clear();
+    }
+    // the exact searches stop at the deadline too, so they never hold the graph off the changes for longer
+    bool complete = true;
+    if (hit) {
+        cost = cached.cost;
+    } else {
+        switch (algorithm) {
+            case 1: {
+                std::lock_guard<std::mutex> lock(resident->mutex);
+                cost = Management::tspBacktracking(g, timeLimitMs, &complete);
+                break;
+            }
+            case 2: {
+                std::lock_guard<std::mutex> lock(resident->mutex);
+                cost = Management::tspTriangular(g, &tour);
+                break;
+            }
+            case 3: {
+                std::lock_guard<std::mutex> lock(resident->mutex);
+                cost = Management::tspOther(g, &tour);
+                break;
+            }
+            case 4: {
+                std::lock_guard<std::mutex> lock(resident->mutex);
+                cost = Management::tspRealWorld(g, g->getInternalId(start), timeLimitMs, &complete);
+                break;
+            }
+            case 5: cost = Management::tspSpaceFillingCurve(g, &tour); break;
+            case 6: {
+                Management::tspSpaceFillingCurve(g, &tour);
+                if (!warmStart.empty() && Management::tourCost(g, warmStart) < Management::tourCost(g, tour))
+                    tour = warmStart;
+                cost = Management::improveTwoOpt(g, tour, timeLimitMs);
+                break;
+            }
+            case 7: cost = Management::tspGreedyEdge(g, &tour); break;
+            case 8: cost = Management::tspSavings(g, &tour); break;
+            case 9: {
+                GeneticOptions geneticOptions;
+                geneticOptions.timeLimitMs = timeLimitMs;
+                geneticOptions.initialTour = warmStart;
+                std::unique_ptr<GeneticSearch> search;
+                {
+                    // the seed tours come from the triangular and nearest neighbour heuristics
+                    std::lock_guard<std::mutex> lock(resident->mutex);
+                    search = std::make_unique<GeneticSearch>(g, geneticOptions);
+                }
+                cost = search->run();
+                tour = search->getBestTour();
+                break;
+            }
+            case 10: {
+                AntColonyOptions colonyOptions;
+                colonyOptions.timeLimitMs = timeLimitMs;
+                AntColony colony(g, colonyOptions);
+                cost = colony.run();
+                tour = colony.getBestTour();
+                break;
+            }
+            case 11: {
+                AnnealingOptions annealingOptions;
+                annealingOptions.timeLimitMs = timeLimitMs;
+                annealingOptions.initialTour = warmStart;
+                SimulatedAnnealing annealing(g, annealingOptions);
+                cost = annealing.run();
+                tour = annealing.getBestTour();
+                break;
+            }
+            case 12: {
+                PortfolioOptions portfolioOptions;
+                portfolioOptions.timeLimitMs = timeLimitMs;
+                // some of its solvers write to the vertices
+                std::lock_guard<std::mutex> lock(resident->mutex);
+                Portfolio portfolio(g, portfolioOptions);
+                cost = portfolio.run();
+                tour = portfolio.getBestTour();
+                engine = portfolio.getWinner();
+                break;
+            }
+        }
+        if (!complete)
+            return answer(request.id, "expired", "\"error\":\"the exact search did not finish before the deadline\"");
+        ResultCache::store(checksum, CachedResult{algorithm, params, start, cost, g->toOriginalIds(tour)});
+    }
+    auto end = Clock::now();
+    if (!tour.empty() && (int) tour.size() == g->getNumVertex()) {
+        std::lock_guard<std::mutex> lock(resident->tourMutex);
+        resident->tour = std::make_unique<DynamicTour>(g, tour);
+    }
+
+    std::ostringstream fields;
+    fields << std::setprecision(15) << "\"cost\":";
+    if (cost == INF)
+        fields << "null";
+    else
+        fields << cost;
+    fields << ",\"queued_ms\":" << std::chrono::duration_cast<std::chrono::milliseconds>(begin - request.received).count()
+           << ",\"ms\":" << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
+           << ",\"cached\":" << (hit ? "true" : "false");
+    if (!engine.empty())
+        fields << ",\"engine\":" << quote(engine);
+    fields << ",\"tour\":" << tourArray(g, tour);
+    return answer(request.id, "ok", fields.str());
+}
+
+/**
+ * @brief Runs an insert, remove or weight request: changes the graph and repairs the tour kept for it
+ * @return answer line with the cost of the repaired tour, the time the change took and the tour
+ * @throws std::runtime_error if the arguments are not valid, or no complete tour was solved for the graph yet
+ */
+std::string Server::update(const Request &request, const std::shared_ptr<Resident> &resident) {
+    if (request.command == "batch")
+        return applyBatch(request, resident);
+    Graph *g = resident->loader->getFuture().get();
+    auto arg = [&](const std::string &key) {
+        auto it = request.args.find(key);
+        if (it == request.args.end())
+            throw std::runtime_error(request.command + " needs " + key);
+        return it->second;
+    };
+    auto number = [&](const std::string &key, double fallback) {
+        auto it = request.args.find(key);
+        return it == request.args.end() ? fallback : std::stod(it->second);
+    };
+    auto vertex = [&](const std::string &key) {
+        int in = g->getInternalId(std::stoi(arg(key)));
+        if (g->findVertex(in) == nullptr)
+            throw std::runtime_error(key + " is not a node of the graph");
+        return in;
+    };
+
+    std::unique_lock<std::shared_mutex> graphLock(resident->graphMutex);
+    std::lock_guard<std::mutex> tourLock(resident->tourMutex);
+    if (resident->tour == nullptr)
+        throw std::runtime_error("no tour to repair, solve the graph first");
+    DynamicTour &tour = *resident->tour;
+    long movesBefore = tour.getMoves();
+    auto begin = Clock::now();
+    if (request.command == "insert") {
+        // the edges are checked before the graph is changed
+        std::vector<std::pair<int, double>> edges;
+        if (request.args.count("edges")) {
+            std::istringstream list(request.args.at("edges"));
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                size_t colon = item.find(':');
+                if (colon == std::string::npos)
+                    throw std::runtime_error("edges must be <id>:<weight> pairs");
+                int in = g->getInternalId(std::stoi(item.substr(0, colon)));
+                if (g->findVertex(in) == nullptr)
+                    throw std::runtime_error("edge to " + item.substr(0, colon) + ", which is not a node of the graph");
+                edges.emplace_back(in, std::stod(item.substr(colon + 1)));
+            }
+        }
+        // the distances to the nodes it is not joined to come from the coordinates, when the graph has them
+        bool coordinates = g->hasCoordinates();
+        if (coordinates && (!request.args.count("lon") || !request.args.count("lat")))
+            throw std::runtime_error("insert needs lon and lat on a graph with coordinates");
+        if (!coordinates && edges.empty())
+            throw std::runtime_error("insert needs edges on a graph without coordinates");
+        int in = g->insertVertex(std::stoi(arg("node")), number("lon", 0), number("lat", 0));
+        if (in < 0)
+            throw std::runtime_error("node is already a node of the graph");
+        for (auto &[other, w] : edges) {
+            g->addBidirectionalEdge(in, other, w);
+            g->addToDistMatrix(in, other, w);
+        }
+        Auxiliar::completeVertex(g, in, coordinates);
+        tour.insert(in);
+    } else if (request.command == "remove") {
+        int in = vertex("node");
+        tour.remove(in);
+        g->removeVertex(in);
+    } else {
+        int from = vertex("from"), to = vertex("to");
+        tour.changeWeight(from, to, std::stod(arg("value")));
+    }
+    resident->modified = true;
+    auto end = Clock::now();
+
+    std::ostringstream fields;
+    fields << std::setprecision(15) << "\"cost\":" << tour.getCost()
+           << ",\"us\":" << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count()
+           << ",\"moves\":" << tour.getMoves() - movesBefore
+           << ",\"vertices\":" << g->getNumVertex()
+           << ",\"tour\":" << tourArray(g, tour.getTour());
+    return answer(request.id, "ok", fields.str());
+}
+
+/**
+ * @brief Runs a batch request: applies all its changes to the graph in one pass (see Graph::apply), and repairs the
+ * tour kept for the graph if there is one
+ * @return answer line with the size of the graph, the time the changes took, and the repaired tour if any
+ * @throws std::runtime_error if a list of the request is not valid
+ */
+std::string Server::applyBatch(const Request &request, const std::shared_ptr<Resident> &resident) {
+    Graph *g = resident->loader->getFuture().get();
+    // each list is items separated by commas, and each item fields separated by colons
+    auto items = [&](const std::string &key, size_t fields) {
+        std::vector<std::vector<std::string>> res;
+        auto it = request.args.find(key);
+        if (it == request.args.end())
+            return res;
+        std::istringstream list(it->second);
+        std::string item, field;
+        while (std::getline(list, item, ',')) {
+            std::istringstream ss(item);
+            res.emplace_back();
+            while (std::getline(ss, field, ':'))
+                res.back().push_back(field);
+            // the coordinates of an inserted node may be left out on a graph without coordinates
+            if (res.back().size() != fields && !(key == "insert" && res.back().size() == 1))
+                throw std::runtime_error(key + " items must have " + std::to_string(fields) + " fields separated by ':'");
+        }
+        return res;
+    };
+    GraphBatch batch;
+    std::vector<int> removed;
+    for (auto &item : items("remove", 1)) {
+        batch.removeVertex(std::stoi(item[0]));
+        removed.push_back(std::stoi(item[0]));
+    }
+    // an inserted node needs coordinates on a graph that has them, and an edge on one that does not
+    std::string bare;
+    std::vector<int> inserted;
+    for (auto &item : items("insert", 3)) {
+        batch.addVertex(std::stoi(item[0]), item.size() > 1 ? std::stod(item[1]) : 0,
+                        item.size() > 1 ? std::stod(item[2]) : 0);
+        inserted.push_back(std::stoi(item[0]));
+        if (item.size() == 1 && bare.empty())
+            bare = item[0];
+    }
+    std::vector<std::pair<int, int>> edges;
+    for (auto &item : items("cut", 2)) {
+        batch.removeEdge(std::stoi(item[0]), std::stoi(item[1]));
+        edges.emplace_back(std::stoi(item[0]), std::stoi(item[1]));
+    }
+    std::set<int> joined;
+    for (auto &item : items("join", 3)) {
+        batch.addEdge(std::stoi(item[0]), std::stoi(item[1]), std::stod(item[2]));
+        edges.emplace_back(std::stoi(item[0]), std::stoi(item[1]));
+        joined.insert({std::stoi(item[0]), std::stoi(item[1])});
+    }
+    if (batch.empty())
+        throw std::runtime_error("batch needs remove, insert, cut or join");
+
+    std::unique_lock<std::shared_mutex> graphLock(resident->graphMutex);
+    std::lock_guard<std::mutex> tourLock(resident->tourMutex);
+    if (g->hasCoordinates()) {
+        if (!bare.empty())
+            throw std::runtime_error("insert " + bare + " needs coordinates on a graph with coordinates");
+    } else {
+        for (int original : inserted) {
+            if (!joined.count(original))
+                throw std::runtime_error("insert " + std::to_string(original) +
+                                         " needs a join on a graph without coordinates");
+        }
+    }
+    auto begin = Clock::now();
+    DynamicTour *tour = resident->tour.get();
+    if (tour != nullptr) {
+        // the removed vertices leave the tour while the infos still name them
+        std::vector<int> gone;
+        for (int original : removed)
+            gone.push_back(g->getInternalId(original));
+        tour->removeAll(gone);
+    }
+    BatchResult result = g->apply(batch);
+    resident->modified = true;
+    if (tour != nullptr) {
+        if (!result.renumbered.empty())
+            tour->renumber(result.renumbered);
+        for (int in : result.added)
+            tour->insert(in);
+        std::vector<int> changed;
+        for (auto [v1, v2] : edges) {
+            changed.push_back(g->getInternalId(v1));
+            changed.push_back(g->getInternalId(v2));
+        }
+        if (!changed.empty())
+            tour->refresh(changed);
+    }
+    auto end = Clock::now();
+
+    std::ostringstream fields;
+    fields << std::setprecision(15) << "\"vertices\":" << g->getNumVertex()
+           << ",\"removed\":" << result.removed.size()
+           << ",\"added\":" << result.added.size()
+           << ",\"compacted\":" << (result.renumbered.empty() ? "false" : "true")
+           << ",\"us\":" << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    if (tour != nullptr)
+        fields << ",\"cost\":" << tour->getCost() << ",\"tour\":" << tourArray(g, tour->getTour());
+    return answer(request.id, "ok", fields.str());
+}
+
+/**
+ * @brief JSON array of the node ids of the dataset along a tour
+ * @param g graph of the tour
+ * @param tour vertex infos
+ */
+std::string Server::tourArray(Graph *g, const std::vector<int> &tour) {
+    std::ostringstream out;
+    out << "[";
+    std::vector<int> ids = g->toOriginalIds(tour);
+    for (size_t i = 0; i < ids.size(); i++)
+        out << (i ? "," : "") << ids[i];
+    out << "]";
+    return out.str();
+}
+
+/**
+ * @brief Graph named by the dataset or tsplib argument, which starts loading in the background the first time
+ * @param args arguments of the request
+ * @param create whether to start loading a graph that is not resident
+ * @return the resident graph, nullptr if it is not resident and create is false
+ * @throws std::runtime_error if the arguments name no dataset
+ */
+std::shared_ptr<Server::Resident> Server::resident(const std::map<std::string, std::string> &args, bool create) {
+    std::string key;
+    DatasetLoader::ReadFunction read;
+    if (args.count("tsplib")) {
+        key = "tsplib:" + args.at("tsplib");
+        read = DatasetLoader::tsplib(args.at("tsplib"));
+    } else if (args.count("dataset")) {
+        int dataset = std::stoi(args.at("dataset"));
+        if (dataset < 0 || dataset >= Auxiliar::NUM_DATASETS)
+            throw std::runtime_error("dataset must be between 0 and 17");
+        key = "dataset:" + std::to_string(dataset);
+        read = DatasetLoader::dataset(dataset);
+    } else {
+        throw std::runtime_error("missing dataset or tsplib");
+    }
+
+    std::lock_guard<std::mutex> lock(residentMutex);
+    auto it = residents.find(key);
+    if (it != residents.end())
+        return it->second;
+    if (!create)
+        return nullptr;
+    auto r = std::make_shared<Resident>();
+    r->loader = std::make_unique<DatasetLoader>(read);
+    residents[key] = r;
+    return r;
+}
+
+/**
+ * @brief Drops a resident graph. Requests running on it keep it alive until they finish.
+ */
+void Server::unload(const std::map<std::string, std::string> &args) {
+    std::shared_ptr<Resident> r = resident(args, false);
+    if (r == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(residentMutex);
+    for (auto it = residents.begin(); it != residents.end(); it++) {
+        if (it->second == r) {
+            residents.erase(it);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Closes the socket once the session and every request of the connection are done
+ */
+Server::Connection::~Connection() {
+    if (in != STDIN_FILENO)
+        close(in);
+}
+
+/**
+ * @brief Writes one answer line, whole, to the connection
+ */
+void Server::Connection::send(const std::string &line) {
+    std::string data = line + "\n";
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = out == STDOUT_FILENO ? write(out, data.data() + sent, data.size() - sent)
+                                         : ::send(out, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+            return;
+        sent += n;
+    }
+}
+
+/**
+ * @brief Answer line as a JSON object
+ * @param id id of the request, left out if empty
+ * @param status ok, error or expired
+ * @param fields more members, already formatted
+ */
+std::string Server::answer(const std::string &id, const std::string &status, const std::string &fields) {
+    std::string res = "{";
+    if (!id.empty())
+        res += "\"id\":" + quote(id) + ",";
+    res += "\"status\":" + quote(status);
+    if (!fields.empty())
+        res += "," + fields;
+    return res + "}";
+}
+
+/**
+ * @brief JSON string literal
+ */
+std::string Server::quote(const std::string &str) {
+    std::ostringstream oss;
+    oss << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            oss << '\\' << c;
+        else if ((unsigned char) c < 0x20)
+            oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec;
+        else
+            oss << c;
+    }
+    oss << '"';
+    return oss.str();
+}
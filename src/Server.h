@@ -0,0 +1,154 @@
+#ifndef PROJECT2_SERVER_H
+#define PROJECT2_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DatasetLoader.h"
+#include "DynamicTour.h"
+#include "ThreadPool.h"
+
+/**
+ * @brief Parameters of the solver server
+ */
+struct ServerOptions {
+    // Unix domain socket to listen on, empty to serve a single session on stdin and stdout
+    std::string socketPath;
+    // threads solving requests, 0 for half the threads of the global pool; the pool keeps the threads left over for
+    // the parallel parts of the solves
+    int workers = 0;
+    // deadline of the requests that do not give one
+    long defaultDeadlineMs = 10000;
+};
+
+/**
+ * @brief Long-running solver: keeps the graphs it loaded resident and answers solve requests from a line protocol,
+ * so a client pays the load once instead of on every run.
+ *
+ * Every request is one line, a command followed by key=value arguments:
+ *  - solve dataset=<0-17>|tsplib=<file> algorithm=<1-12> [start=<node>] [deadline=<ms>] [id=<n>]
+ *  - load dataset=<0-17>|tsplib=<file> [id=<n>]
+ *  - unload dataset=<0-17>|tsplib=<file> [id=<n>]
+ *  - insert dataset=<0-17>|tsplib=<file> node=<id> [lon=<x> lat=<y>] [edges=<id>:<w>,...] [id=<n>]
+ *  - remove dataset=<0-17>|tsplib=<file> node=<id> [id=<n>]
+ *  - weight dataset=<0-17>|tsplib=<file> from=<id> to=<id> value=<w> [id=<n>]
+ *  - batch dataset=<0-17>|tsplib=<file> [remove=<id>,...] [insert=<id>[:<lon>:<lat>],...] [cut=<id>:<id>,...]
+ *    [join=<id>:<id>:<w>,...] [id=<n>]
+ *  - ping, quit (closes the connection) and shutdown (stops the server)
+ * and every answer is one JSON object on a line, carrying the id of its request since answers come back in the order
+ * requests finish. The tour is given with the node ids of the dataset.
+ *
+ * Requests are queued and handed to the workers earliest deadline first. A request still queued at its deadline is
+ * answered as expired, and the time-bounded algorithms (6 and 9 to 12) get whatever time is left. The exact searches
+ * (1 and 4) stop at the deadline as well, and are answered as expired if they did not finish. The graphs are shared
+ * between the workers; the algorithms that write to the vertices (1 to 4, 12, and the seeding of 9) hold the mutex of
+ * their graph, the others only read it and run concurrently.
+ *
+ * With a result cache, the algorithms that always give the same tour are answered from it ("cached":true), and the
+ * time-bounded ones start from the best tour it holds for the dataset.
+ *
+ * The last complete tour solved for a graph is kept, and insert, remove and weight change the graph and repair that
+ * tour in place (see DynamicTour) instead of solving again; they answer with the repaired tour. An inserted node needs
+ * coordinates on a graph that has them, since they give its distances to the nodes it has no edge to, and an edge on a
+ * graph that does not. batch applies many vertex and edge changes in one pass (see Graph::apply), such as pruning a
+ * graph before solving it, and repairs the tour too if there is one. A changed graph no longer matches its files, so
+ * its results are neither read from nor stored in the cache. Changes wait for the solves running on the graph, which
+ * only read it, and hold them off while they apply.
+ */
+class Server {
+public:
+    explicit Server(const ServerOptions &options);
+    ~Server();
+
+    int run();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Client connection, or stdin and stdout. Answers from several workers are written whole, one at a time.
+     */
+    struct Connection {
+        int in;
+        int out;
+        std::mutex mutex;
+        ~Connection();
+        void send(const std::string &line);
+    };
+
+    /**
+     * @brief Graph kept in memory, with the mutex held by the algorithms that write to its vertices, and the lock that
+     * solves share and changes of the graph take alone
+     */
+    struct Resident {
+        std::unique_ptr<DatasetLoader> loader;
+        std::mutex mutex;
+        std::shared_mutex graphMutex;
+        // tour the changes repair, replaced by every complete tour a solve finds
+        std::mutex tourMutex;
+        std::unique_ptr<DynamicTour> tour;
+        bool modified = false;
+    };
+
+    /**
+     * @brief Thread serving one connection, and whether it is done, so the accept loop can join it
+     */
+    struct Session {
+        std::thread thread;
+        std::weak_ptr<Connection> connection;
+        std::shared_ptr<std::atomic<bool>> finished;
+    };
+
+    struct Request {
+        std::string id;
+        std::string command;
+        std::map<std::string, std::string> args;
+        Clock::time_point received;
+        Clock::time_point deadline;
+        std::shared_ptr<Connection> connection;
+
+        bool operator<(const Request &other) const;
+    };
+
+    void serve(std::shared_ptr<Connection> connection);
+    void reapSessions();
+    bool handleLine(const std::string &line, const std::shared_ptr<Connection> &connection);
+    void runNext();
+    std::string execute(const Request &request);
+    std::string solve(const Request &request, const std::shared_ptr<Resident> &resident);
+    std::string update(const Request &request, const std::shared_ptr<Resident> &resident);
+    std::string applyBatch(const Request &request, const std::shared_ptr<Resident> &resident);
+
+    std::shared_ptr<Resident> resident(const std::map<std::string, std::string> &args, bool create);
+    void unload(const std::map<std::string, std::string> &args);
+
+    static std::string answer(const std::string &id, const std::string &status, const std::string &fields = "");
+    static std::string quote(const std::string &str);
+    static std::string tourArray(Graph *g, const std::vector<int> &tour);
+
+    ServerOptions options;
+    ThreadPool workers;
+
+    std::mutex queueMutex;
+    std::priority_queue<Request> queue;
+    std::atomic<long> pending{0};
+    std::condition_variable idle;
+
+    std::mutex residentMutex;
+    std::map<std::string, std::shared_ptr<Resident>> residents;
+
+    std::atomic<bool> stopping{false};
+    int listenFd = -1;
+    std::vector<Session> sessions;
+};
+
+#endif //PROJECT2_SERVER_H
@@ -0,0 +1,215 @@
+#include "SimulatedAnnealing.h"
+#include "Graph.h"
+#include "Management.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+/**
+ * @brief Seeds every chain with the greedy edge tour, or the initial tour of the options, and sets up the temperature
+ * ladder
+ * @param graph graph with a complete distance matrix
+ * @param options parameters of the search
+ * @details Time Complexity O(v² / t + v k log(v k)) for the seed tour -> v: number of vertices, t: number of threads,
+ * k: candidates per vertex
+ */
+SimulatedAnnealing::SimulatedAnnealing(Graph *graph, const AnnealingOptions &options)
+        : graph(graph), options(options), n(graph->getNumVertex()), bestCost(INF) {
+    TRACE_SPAN("SimulatedAnnealing seed", "solve");
+    if (n == 0)
+        return;
+
+    std::vector<int> seed = options.initialTour;
+    double seedCost = (int) seed.size() == n ? Management::tourCost(graph, seed) : Management::tspGreedyEdge(graph, &seed);
+    best = seed;
+    bestCost = seedCost;
+
+    int count = options.chains > 0 ? options.chains : std::max<int>(4, ThreadPool::global().getNumThreads());
+    if (this->options.movesPerEpoch <= 0)
+        this->options.movesPerEpoch = 20L * n;
+
+    double averageEdge = seedCost / n;
+    double hot = std::max(averageEdge * options.hotFraction, 1e-9);
+    double cold = std::max(averageEdge * options.coldFraction, 1e-12);
+    chains.resize(count);
+    for (int c = 0; c < count; c++) {
+        Chain &chain = chains[c];
+        chain.tour = seed;
+        chain.cost = seedCost;
+        chain.temperature = count == 1 ? cold : cold * std::pow(hot / cold, (double) c / (count - 1));
+        chain.rng.seed(options.seed + c);
+    }
+}
+
+/**
+ * @brief Runs epochs until the time limit or the target cost: every chain tries movesPerEpoch moves in parallel,
+ * then neighbouring chains on the ladder swap tours with probability min(1, exp((E_i - E_j)(1 / T_i - 1 / T_j)))
+ * @return Cost of the best tour found
+ * @details Time Complexity O(m + a v) per chain and epoch -> m: moves per epoch, a: accepted moves,
+ * v: number of vertices
+ */
+double SimulatedAnnealing::run() {
+    TRACE_SPAN("SimulatedAnnealing", "solve");
+    if (n < 5 || chains.empty())
+        return bestCost == INF ? 0 : bestCost;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeLimitMs);
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    int epoch = 0;
+    do {
+        ThreadPool::global().parallelFor(0, chains.size(), 1, [&](int lo, int hi) {
+            for (int c = lo; c < hi; c++)
+                anneal(chains[c], options.movesPerEpoch);
+        });
+
+        for (Chain &chain : chains) {
+            // the deltas add up rounding errors, start the next epoch from the exact cost
+            chain.cost = cost(chain.tour);
+            if (chain.cost < bestCost) {
+                bestCost = chain.cost;
+                best = chain.tour;
+            }
+        }
+        if (options.targetCost > 0 && bestCost <= options.targetCost)
+            break;
+
+        // alternate even and odd pairs so every pair of neighbours gets its chance
+        for (size_t c = epoch % 2; c + 1 < chains.size(); c += 2) {
+            Chain &cold = chains[c], &hot = chains[c + 1];
+            double exponent = (cold.cost - hot.cost) * (1 / cold.temperature - 1 / hot.temperature);
+            if (exponent >= 0 || unit(rng) < std::exp(exponent)) {
+                std::swap(cold.tour, hot.tour);
+                std::swap(cold.cost, hot.cost);
+            }
+        }
+        epoch++;
+    } while (std::chrono::steady_clock::now() < deadline && !(options.stop != nullptr && *options.stop));
+
+    Memory::noteScratch(chains.size() * n * sizeof(int));
+    return bestCost;
+}
+
+/**
+ * @brief Metropolis moves on one chain at its temperature. Each move picks 2-opt, swap or insertion at random, and is
+ * accepted if it shortens the tour, or else with probability exp(-delta / temperature).
+ * @param chain chain to update
+ * @param moves number of moves to try
+ */
+void SimulatedAnnealing::anneal(Chain &chain, long moves) {
+    std::vector<int> &t = chain.tour;
+    std::uniform_real_distribution<double> unit(0, 1);
+    for (long m = 0; m < moves; m++) {
+        int i = chain.rng() % n, j = chain.rng() % n;
+        if (i > j)
+            std::swap(i, j);
+        int kind = chain.rng() % 3;
+
+        double delta;
+        if (kind == 0) {
+            if (j - i < 2 || (i == 0 && j == n - 1))
+                continue;
+            delta = twoOptDelta(t, i, j);
+        } else if (kind == 1) {
+            if (j - i < 2 || (i == 0 && j == n - 1))
+                continue;
+            delta = swapDelta(t, i, j);
+        } else {
+            if (i == j || (j + 1) % n == i || (i + 1) % n == j)
+                continue;
+            delta = insertionDelta(t, i, j);
+        }
+        chain.moves++;
+
+        if (delta >= 0 && unit(chain.rng) >= std::exp(-delta / chain.temperature))
+            continue;
+
+        chain.accepted++;
+        chain.cost += delta;
+        if (kind == 0) {
+            std::reverse(t.begin() + i + 1, t.begin() + j + 1);
+        } else if (kind == 1) {
+            std::swap(t[i], t[j]);
+        } else {
+            // t[i] goes right after t[j], everything in between shifts by one
+            std::rotate(t.begin() + i, t.begin() + i + 1, t.begin() + j + 1);
+        }
+    }
+}
+
+/**
+ * @brief Change in cost of replacing the edges (t[i], t[i + 1]) and (t[j], t[j + 1]) by (t[i], t[j]) and
+ * (t[i + 1], t[j + 1]), which reverses t[i + 1..j]
+ * @details Time Complexity O(1)
+ */
+double SimulatedAnnealing::twoOptDelta(const std::vector<int> &t, int i, int j) const {
+    int a = t[i], b = t[i + 1], c = t[j], d = t[(j + 1) % n];
+    return dist(a, c) + dist(b, d) - dist(a, b) - dist(c, d);
+}
+
+/**
+ * @brief Change in cost of exchanging t[i] and t[j], which are not next to each other
+ * @details Time Complexity O(1)
+ */
+double SimulatedAnnealing::swapDelta(const std::vector<int> &t, int i, int j) const {
+    int pa = t[(i + n - 1) % n], a = t[i], na = t[i + 1];
+    int pb = t[j - 1], b = t[j], nb = t[(j + 1) % n];
+    return dist(pa, b) + dist(b, na) + dist(pb, a) + dist(a, nb)
+           - dist(pa, a) - dist(a, na) - dist(pb, b) - dist(b, nb);
+}
+
+/**
+ * @brief Change in cost of moving t[i] to between t[j] and t[j + 1], with i < j and neither next to the other
+ * @details Time Complexity O(1)
+ */
+double SimulatedAnnealing::insertionDelta(const std::vector<int> &t, int i, int j) const {
+    int p = t[(i + n - 1) % n], a = t[i], na = t[i + 1];
+    int b = t[j], nb = t[(j + 1) % n];
+    return dist(p, na) + dist(b, a) + dist(a, nb) - dist(p, a) - dist(a, na) - dist(b, nb);
+}
+
+/**
+ * @brief Cost of a closed tour of vertex infos
+ */
+double SimulatedAnnealing::cost(const std::vector<int> &tour) const {
+    return Management::tourCost(graph, tour);
+}
+
+double SimulatedAnnealing::dist(int a, int b) const {
+    return graph->getDist(a, b);
+}
+
+/**
+ * @brief Best tour found, the greedy edge seed if run was not called
+ * @return vertex infos of the tour, starting at node 0 of the dataset
+ */
+std::vector<int> SimulatedAnnealing::getBestTour() const {
+    std::vector<int> tour = best;
+    auto first = std::find(tour.begin(), tour.end(), graph->getInternalId(0));
+    if (first != tour.end())
+        std::rotate(tour.begin(), first, tour.end());
+    return tour;
+}
+
+/**
+ * @brief Moves tried by all chains together
+ */
+long SimulatedAnnealing::getMoves() const {
+    long total = 0;
+    for (const Chain &chain : chains)
+        total += chain.moves;
+    return total;
+}
+
+/**
+ * @brief Moves accepted by all chains together
+ */
+long SimulatedAnnealing::getAccepted() const {
+    long total = 0;
+    for (const Chain &chain : chains)
+        total += chain.accepted;
+    return total;
+}
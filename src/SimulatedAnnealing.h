@@ -0,0 +1,78 @@
+#ifndef PROJECT2_SIMULATEDANNEALING_H
+#define PROJECT2_SIMULATEDANNEALING_H
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+class Graph;
+
+/**
+ * @brief Parameters of the simulated annealing
+ */
+struct AnnealingOptions {
+    // number of chains, 0 for one per thread of the pool (at least 4, so the temperature ladder has some steps)
+    int chains = 0;
+    // hottest and coldest temperatures, as fractions of the average edge of the seed tour
+    double hotFraction = 0.3;
+    double coldFraction = 0.002;
+    // moves each chain tries between two replica exchanges, 0 for 20 per vertex
+    long movesPerEpoch = 0;
+    long timeLimitMs = 10000;
+    // flag set by another thread to end the search before the time limit, such as a rival solver proving optimality;
+    // ignored if null
+    const std::atomic<bool> *stop = nullptr;
+    // the search stops as soon as a tour at most this long is found, 0 to only stop at the time limit
+    double targetCost = 0;
+    uint32_t seed = 1;
+    // tour of vertex infos the chains start from instead of the greedy edge tour, such as a result found earlier;
+    // ignored if empty
+    std::vector<int> initialTour;
+};
+
+/**
+ * @brief Parallel tempering simulated annealing: one Metropolis chain per thread of the pool, each at a fixed
+ * temperature of a geometric ladder, which trades its tour with its neighbour on the ladder after every epoch when the
+ * replica exchange test passes. Hot chains explore, cold chains refine whatever the hot ones hand down.
+ * Moves are 2-opt, swap and insertion, each evaluated in O(1) from the four to six distances it changes.
+ */
+class SimulatedAnnealing {
+public:
+    SimulatedAnnealing(Graph *graph, const AnnealingOptions &options);
+
+    double run();
+    std::vector<int> getBestTour() const;
+    long getMoves() const;
+    long getAccepted() const;
+
+private:
+    /**
+     * @brief State of one chain: its tour of vertex infos, the cost of that tour and its temperature
+     */
+    struct Chain {
+        std::vector<int> tour;
+        double cost;
+        double temperature;
+        std::mt19937 rng;
+        long moves = 0;
+        long accepted = 0;
+    };
+
+    void anneal(Chain &chain, long moves);
+    double twoOptDelta(const std::vector<int> &t, int i, int j) const;
+    double swapDelta(const std::vector<int> &t, int i, int j) const;
+    double insertionDelta(const std::vector<int> &t, int i, int j) const;
+    double cost(const std::vector<int> &tour) const;
+    double dist(int a, int b) const;
+
+    Graph *graph;
+    AnnealingOptions options;
+    int n;
+
+    std::vector<Chain> chains;
+    std::vector<int> best;
+    double bestCost;
+};
+
+#endif //PROJECT2_SIMULATEDANNEALING_H
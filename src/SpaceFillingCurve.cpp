@@ -0,0 +1,132 @@
+#include "SpaceFillingCurve.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+/**
+ * @brief Position of a grid cell along the Hilbert curve
+ * @param x column, below 2^ORDER
+ * @param y row, below 2^ORDER
+ * @return distance along the curve
+ * @details Time Complexity O(ORDER)
+ */
+uint64_t SpaceFillingCurve::hilbertKey(uint32_t x, uint32_t y) {
+    const uint32_t n = 1u << ORDER;
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += (uint64_t) s * s * ((3 * rx) ^ ry);
+        // rotate the quadrant so the sub-curve has the right orientation
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+/**
+ * @brief Position of a grid cell along the Morton (Z-order) curve, interleaving the bits of x and y
+ * @param x column, below 2^ORDER
+ * @param y row, below 2^ORDER
+ * @return distance along the curve
+ */
+uint64_t SpaceFillingCurve::mortonKey(uint32_t x, uint32_t y) {
+    auto spread = [](uint64_t v) {
+        v &= 0xffffffffULL;
+        v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+        v = (v | (v << 8)) & 0x00ff00ff00ff00ffULL;
+        v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        v = (v | (v << 2)) & 0x3333333333333333ULL;
+        v = (v | (v << 1)) & 0x5555555555555555ULL;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+/**
+ * @brief Quantises the points to a 2^ORDER grid over their bounding box and computes their curve keys
+ * @param xs x coordinates (longitudes)
+ * @param ys y coordinates (latitudes)
+ * @param curve curve to use
+ * @return key of each point
+ * @details Time Complexity O(n) -> n: number of points
+ */
+std::vector<uint64_t> SpaceFillingCurve::keys(const std::vector<double> &xs, const std::vector<double> &ys, Curve curve) {
+    int n = xs.size();
+    std::vector<uint64_t> res(n, 0);
+    if (n == 0 || curve == Curve::None)
+        return res;
+
+    auto [minX, maxX] = std::minmax_element(xs.begin(), xs.end());
+    auto [minY, maxY] = std::minmax_element(ys.begin(), ys.end());
+    // same scale on both axes so the curve does not stretch the plane
+    double span = std::max({*maxX - *minX, *maxY - *minY, 1e-12});
+    double scale = ((1u << ORDER) - 1) / span;
+
+    double x0 = *minX, y0 = *minY;
+    ThreadPool::global().parallelFor(0, n, 16384, [&](int lo, int hi) {
+        for (int i = lo; i < hi; i++) {
+            auto x = (uint32_t) ((xs[i] - x0) * scale);
+            auto y = (uint32_t) ((ys[i] - y0) * scale);
+            res[i] = curve == Curve::Hilbert ? hilbertKey(x, y) : mortonKey(x, y);
+        }
+    });
+    return res;
+}
+
+/**
+ * @brief Orders points along a curve
+ * @param xs x coordinates (longitudes)
+ * @param ys y coordinates (latitudes)
+ * @param curve curve to use
+ * @return indices of the points in curve order, ties broken by index so the order is deterministic
+ * @details Time Complexity O(n log(n) / t) -> n: number of points, t: number of threads
+ */
+std::vector<int> SpaceFillingCurve::order(const std::vector<double> &xs, const std::vector<double> &ys, Curve curve) {
+    int n = xs.size();
+    std::vector<int> perm(n);
+    std::iota(perm.begin(), perm.end(), 0);
+    if (curve == Curve::None)
+        return perm;
+
+    // sort (key, index) pairs, so ties are broken by index and the comparisons stay in contiguous memory
+    std::vector<uint64_t> k = keys(xs, ys, curve);
+    std::vector<std::pair<uint64_t, int>> entries(n);
+    for (int i = 0; i < n; i++)
+        entries[i] = {k[i], i};
+    ThreadPool::global().parallelSort(entries, std::less<>());
+
+    for (int i = 0; i < n; i++)
+        perm[i] = entries[i].second;
+    return perm;
+}
+
+/**
+ * @brief Curve from its name
+ * @param name "hilbert", "morton" or "none"
+ * @throws std::invalid_argument if the name is none of those
+ */
+Curve SpaceFillingCurve::parse(const std::string &name) {
+    if (name == "hilbert")
+        return Curve::Hilbert;
+    if (name == "morton")
+        return Curve::Morton;
+    if (name == "none")
+        return Curve::None;
+    throw std::invalid_argument("Unknown curve: " + name);
+}
+
+std::string SpaceFillingCurve::name(Curve curve) {
+    switch (curve) {
+        case Curve::Hilbert: return "hilbert";
+        case Curve::Morton: return "morton";
+        default: return "none";
+    }
+}
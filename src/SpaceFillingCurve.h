@@ -0,0 +1,37 @@
+#ifndef PROJECT2_SPACEFILLINGCURVE_H
+#define PROJECT2_SPACEFILLINGCURVE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Space-filling curves available to order points
+ */
+enum class Curve {
+    None,
+    Hilbert,
+    Morton
+};
+
+/**
+ * @brief Keys and orderings of 2D points along a space-filling curve.
+ * Points close on the curve are close in the plane, so visiting them in curve order keeps neighbours together.
+ */
+class SpaceFillingCurve {
+public:
+    /**
+     * @brief Bits per coordinate of the grid the points are quantised to
+     */
+    static const int ORDER = 21;
+
+    static uint64_t hilbertKey(uint32_t x, uint32_t y);
+    static uint64_t mortonKey(uint32_t x, uint32_t y);
+    static std::vector<uint64_t> keys(const std::vector<double> &xs, const std::vector<double> &ys, Curve curve);
+    static std::vector<int> order(const std::vector<double> &xs, const std::vector<double> &ys, Curve curve);
+
+    static Curve parse(const std::string &name);
+    static std::string name(Curve curve);
+};
+
+#endif //PROJECT2_SPACEFILLINGCURVE_H
@@ -0,0 +1,132 @@
+#include "Stats.h"
+
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+namespace {
+    /**
+     * @brief Every block ever handed out. Blocks are never freed so collect() stays valid after a thread exits.
+     */
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<Stats::Block>> registry;
+}
+
+/**
+ * @brief Difference between two snapshots, used to isolate the work done between them
+ * @param other earlier snapshot
+ * @return this - other
+ */
+StatsSnapshot StatsSnapshot::operator-(const StatsSnapshot &other) const {
+    StatsSnapshot res;
+    for (int i = 0; i < (int) Counter::COUNT; i++)
+        res.counters[i] = counters[i] - other.counters[i];
+    for (int i = 0; i < (int) Phase::COUNT; i++)
+        res.phaseMs[i] = phaseMs[i] - other.phaseMs[i];
+    return res;
+}
+
+/**
+ * @brief Starts timing a phase
+ * @param phase phase to accumulate into
+ */
+Stats::ScopedTimer::ScopedTimer(Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+
+/**
+ * @brief Adds the elapsed time to the phase of the current thread
+ */
+Stats::ScopedTimer::~ScopedTimer() {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    auto &p = local().phaseNs[(int) phase];
+    p.store(p.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Whether the instrumentation was compiled in
+ */
+bool Stats::enabled() {
+#ifdef TSP_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Block of the calling thread, registered on first use
+ * @return block owned by the current thread
+ */
+Stats::Block &Stats::local() {
+    thread_local Block *block = nullptr;
+    if (block == nullptr) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<Block>());
+        block = registry.back().get();
+    }
+    return *block;
+}
+
+/**
+ * @brief Sums the blocks of every thread
+ * @return totals since the start of the program
+ * @details Time Complexity O(t) -> t: number of threads that recorded anything
+ */
+StatsSnapshot Stats::collect() {
+    StatsSnapshot res;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto &block : registry) {
+        for (int i = 0; i < (int) Counter::COUNT; i++)
+            res.counters[i] += block->counters[i].load(std::memory_order_relaxed);
+        for (int i = 0; i < (int) Phase::COUNT; i++)
+            res.phaseMs[i] += block->phaseNs[i].load(std::memory_order_relaxed) / 1e6;
+    }
+    return res;
+}
+
+/**
+ * @brief Formats the non-zero counters and phases of a snapshot
+ * @param snapshot totals to print
+ * @return one line per counter or phase, empty if the instrumentation is compiled out
+ */
+std::string Stats::report(const StatsSnapshot &snapshot) {
+    std::ostringstream oss;
+    if (!enabled())
+        return oss.str();
+
+    for (int i = 0; i < (int) Counter::COUNT; i++) {
+        if (snapshot.counters[i] != 0)
+            oss << " - " << counterName((Counter) i) << ": " << snapshot.counters[i] << "\n";
+    }
+    for (int i = 0; i < (int) Phase::COUNT; i++) {
+        if (snapshot.phaseMs[i] > 0)
+            oss << " - " << phaseName((Phase) i) << ": " << std::fixed << std::setprecision(3) << snapshot.phaseMs[i] << "ms\n";
+    }
+    return oss.str();
+}
+
+const char *Stats::counterName(Counter counter) {
+    switch (counter) {
+        case Counter::RowsParsed: return "Rows parsed";
+        case Counter::HaversineCalls: return "Haversine calls";
+        case Counter::BacktrackingCalls: return "Backtracking nodes expanded";
+        case Counter::BacktrackingPruned: return "Backtracking nodes pruned";
+        case Counter::MstRowScans: return "MST rows scanned";
+        case Counter::SubgradientIterations: return "Subgradient iterations";
+        default: return "";
+    }
+}
+
+const char *Stats::phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::Load: return "Load time";
+        case Phase::MatrixInit: return "Matrix allocation time";
+        case Phase::MatrixFill: return "Matrix fill time";
+        case Phase::Mst: return "MST time";
+        case Phase::Preorder: return "Preorder visit time";
+        case Phase::Search: return "Search time";
+        case Phase::LowerBound: return "Lower bound time";
+        default: return "";
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef PROJECT2_STATS_H
+#define PROJECT2_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Hot-path counters recorded by the loaders and the solvers
+ */
+enum class Counter {
+    RowsParsed,
+    HaversineCalls,
+    BacktrackingCalls,
+    BacktrackingPruned,
+    MstRowScans,
+    SubgradientIterations,
+    COUNT
+};
+
+/**
+ * @brief Phases timed by the scoped timers
+ */
+enum class Phase {
+    Load,
+    MatrixInit,
+    MatrixFill,
+    Mst,
+    Preorder,
+    Search,
+    LowerBound,
+    COUNT
+};
+
+/**
+ * @brief Totals of every counter and phase timer, summed over all threads
+ */
+struct StatsSnapshot {
+    std::array<unsigned long long, (int) Counter::COUNT> counters{};
+    std::array<double, (int) Phase::COUNT> phaseMs{};
+
+    StatsSnapshot operator-(const StatsSnapshot &other) const;
+};
+
+/**
+ * @brief Low-overhead instrumentation layer.
+ * Each thread writes to its own block of counters, so incrementing never contends; collect() sums every block.
+ * Everything is compiled out unless TSP_STATS is defined.
+ */
+class Stats {
+public:
+    /**
+     * @brief Per-thread block of counters and accumulated phase times (in nanoseconds)
+     */
+    struct Block {
+        std::array<std::atomic<unsigned long long>, (int) Counter::COUNT> counters{};
+        std::array<std::atomic<unsigned long long>, (int) Phase::COUNT> phaseNs{};
+    };
+
+    /**
+     * @brief Adds the elapsed time of its scope to a phase of the current thread
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Phase phase);
+        ~ScopedTimer();
+    private:
+        Phase phase;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static bool enabled();
+    static Block &local();
+    static StatsSnapshot collect();
+    static std::string report(const StatsSnapshot &snapshot);
+
+    static const char *counterName(Counter counter);
+    static const char *phaseName(Phase phase);
+
+    /**
+     * @brief Increments a counter of the current thread. Only the owning thread writes, so no read-modify-write is needed.
+     */
+    static inline void add(Counter counter, unsigned long long n = 1) {
+        auto &c = local().counters[(int) counter];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+#ifdef TSP_STATS
+#define STATS_CONCAT_(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT_(a, b)
+#define STATS_INC(counter) Stats::add(counter)
+#define STATS_ADD(counter, n) Stats::add(counter, n)
+#define STATS_TIMER(phase) Stats::ScopedTimer STATS_CONCAT(statsTimer, __LINE__)(phase)
+#else
+#define STATS_INC(counter) ((void) 0)
+#define STATS_ADD(counter, n) ((void) 0)
+#define STATS_TIMER(phase) ((void) 0)
+#endif
+
+#endif //PROJECT2_STATS_H
@@ -0,0 +1,304 @@
+#include "ThreadPool.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// pool and deque of the worker running on this thread, none for the other threads
+thread_local const ThreadPool *currentPool = nullptr;
+thread_local int currentQueue = -1;
+
+// size of the global pool, set before its first use
+unsigned globalThreads = 0;
+bool globalPinned = false;
+
+/**
+ * @brief Pins the calling thread to one core; does nothing where affinity is not supported
+ */
+void pinToCore(unsigned core) {
+#ifdef __linux__
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cores, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void) core;
+#endif
+}
+
+}
+
+/**
+ * @brief Starts the worker threads
+ * @param numThreads number of workers, the thread calling parallelFor works as well
+ * @param pinned whether worker i is pinned to core i + 1, leaving core 0 to the calling thread
+ */
+ThreadPool::ThreadPool(unsigned numThreads, bool pinned) {
+    start(numThreads, pinned);
+}
+
+/**
+ * @brief Finishes the queued tasks and joins the workers
+ */
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+/**
+ * @brief Process-wide pool, by default one worker per hardware thread besides the caller
+ */
+ThreadPool &ThreadPool::global() {
+    static ThreadPool pool((globalThreads > 0 ? globalThreads : std::max(1u, std::thread::hardware_concurrency())) - 1,
+                           globalPinned);
+    return pool;
+}
+
+/**
+ * @brief Sets the size of the global pool. Before its first use it is created with that size, afterwards it is
+ * resized, which must not happen while it runs work.
+ * @param threads threads running work, the caller included, 0 for one per hardware thread
+ * @param pinned whether the workers are pinned to cores
+ */
+void ThreadPool::configureGlobal(unsigned threads, bool pinned) {
+    globalThreads = threads;
+    globalPinned = pinned;
+    ThreadPool &pool = global();
+    unsigned workers = (threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) - 1;
+    if (pool.numWorkers != workers || pool.pinned != pinned)
+        pool.resize(workers, pinned);
+}
+
+/**
+ * @brief Number of threads that run work: the workers plus the calling thread
+ */
+unsigned ThreadPool::getNumThreads() const {
+    return numWorkers + 1;
+}
+
+bool ThreadPool::isPinned() const {
+    return pinned;
+}
+
+/**
+ * @brief Replaces the workers, after they finish the queued tasks. Must not be called while the pool runs work.
+ * @param numThreads number of workers
+ * @param pin whether the workers are pinned to cores
+ */
+void ThreadPool::resize(unsigned numThreads, bool pin) {
+    stop();
+    start(numThreads, pin);
+}
+
+/**
+ * @brief Queues a task to run on one of the workers. A worker queues it on its own deque, other threads spread their
+ * tasks over all of them. Without workers the task runs right away on the caller.
+ * @param task task to run
+ */
+void ThreadPool::submit(std::function<void()> task) {
+    if (queues.empty()) {
+        task();
+        return;
+    }
+    unsigned index = currentPool == this ? currentQueue : nextQueue++ % queues.size();
+    push(index, std::move(task));
+}
+
+/**
+ * @brief Queues a task on the deque of one worker, which runs it unless another thread steals it first
+ * @param worker index of the worker, taken modulo the number of workers
+ * @param task task to run
+ */
+void ThreadPool::submitTo(unsigned worker, std::function<void()> task) {
+    if (queues.empty()) {
+        task();
+        return;
+    }
+    push(worker % queues.size(), std::move(task));
+}
+
+void ThreadPool::start(unsigned numThreads, bool pin) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    pinned = pin;
+    for (unsigned i = 0; i < numThreads; i++)
+        queues.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < numThreads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    numWorkers = numThreads;
+}
+
+void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto &t : workers)
+        t.join();
+    workers.clear();
+    queues.clear();
+    numWorkers = 0;
+}
+
+void ThreadPool::push(unsigned index, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    ++queued;
+    // taking the lock orders the increment before the check of a worker about to sleep
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    cv.notify_one();
+}
+
+/**
+ * @brief Takes a task: the newest of the worker's own deque, or else the oldest of another deque
+ * @param index deque of the calling worker
+ * @param task where the task is moved to
+ * @return false if every deque was empty
+ */
+bool ThreadPool::pop(unsigned index, std::function<void()> &task) {
+    if (queued == 0)
+        return false;
+    {
+        Queue &own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued;
+            return true;
+        }
+    }
+    for (size_t k = 1; k < queues.size(); k++) {
+        Queue &victim = *queues[(index + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Runs tasks of its own deque, steals when it is empty and sleeps when every deque is, until the pool stops
+ * and the tasks left are done
+ */
+void ThreadPool::workerLoop(unsigned index) {
+    currentPool = this;
+    currentQueue = index;
+    if (pinned)
+        pinToCore(index + 1);
+    while (true) {
+        std::function<void()> task;
+        if (pop(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
+
+/**
+ * @brief Creates an empty group
+ * @param pool pool the tasks run on
+ */
+TaskGroup::TaskGroup(ThreadPool &pool) : pool(pool), state(std::make_shared<State>()) {}
+
+/**
+ * @brief Waits for the tasks still running; their errors are dropped
+ */
+TaskGroup::~TaskGroup() {
+    waitPending();
+}
+
+/**
+ * @brief Runs a task on the pool, or right away on the caller if the pool has no workers
+ * @param task task to run
+ */
+void TaskGroup::run(std::function<void()> task) {
+    ++state->pending;
+    {
+        std::lock_guard<std::mutex> lock(state->m);
+        state->tasks.push_back(std::move(task));
+    }
+    // the worker runs whichever task of the group is still waiting, which may have been taken by wait already
+    auto s = state;
+    pool.submit([s]() { s->runOne(); });
+}
+
+/**
+ * @brief Runs the oldest task of the group not started yet, skipping it if the group was cancelled
+ * @return false if every task was already started
+ */
+bool TaskGroup::State::runOne() {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (tasks.empty())
+            return false;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+    }
+    if (!cancelled) {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m);
+            if (!error)
+                error = std::current_exception();
+            cancelled = true;
+        }
+    }
+    if (--pending == 0) {
+        std::lock_guard<std::mutex> lock(m);
+        cv.notify_all();
+    }
+    return true;
+}
+
+/**
+ * @brief Waits for every task of the group, running the ones no worker has started meanwhile
+ * @throws the first exception thrown by a task of the group
+ */
+void TaskGroup::wait() {
+    waitPending();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(state->m);
+        std::swap(error, state->error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/**
+ * @brief Skips the tasks of the group that did not start yet
+ */
+void TaskGroup::cancel() {
+    state->cancelled = true;
+}
+
+bool TaskGroup::isCancelled() const {
+    return state->cancelled;
+}
+
+void TaskGroup::waitPending() {
+    while (state->runOne());
+    std::unique_lock<std::mutex> lock(state->m);
+    state->cv.wait(lock, [this]() { return state->pending == 0; });
+}
@@ -0,0 +1,237 @@
+#ifndef PROJECT2_THREADPOOL_H
+#define PROJECT2_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing pool of worker threads shared by the loaders and the solvers.
+ *
+ * Every worker has its own deque of tasks: tasks submitted by a worker go to its own deque and it takes the newest one
+ * first, while tasks submitted by other threads are spread over the deques. A worker whose deque is empty steals the
+ * oldest task of another one, so nested parallel loops stay on the thread that spawned them while idle threads still
+ * find work. The process uses one pool, global(), whose size is set once from the command line or the menu, so
+ * several solves running at once share its threads instead of each starting their own.
+ */
+class ThreadPool {
+public:
+    // most threads the pool can be configured with from the command line or the menu
+    static const int MAX_THREADS = 1024;
+
+    explicit ThreadPool(unsigned numThreads, bool pinned = false);
+    ~ThreadPool();
+
+    static ThreadPool &global();
+    static void configureGlobal(unsigned threads, bool pinned);
+
+    unsigned getNumThreads() const;
+    bool isPinned() const;
+    void resize(unsigned numThreads, bool pinned);
+
+    void submit(std::function<void()> task);
+    void submitTo(unsigned worker, std::function<void()> task);
+
+    /**
+     * @brief Runs body(lo, hi) over [begin, end) split in chunks of grain iterations, in parallel.
+     * Chunks are handed out dynamically, the calling thread takes part and the call returns when every chunk is done.
+     * @param begin first iteration
+     * @param end one past the last iteration
+     * @param grain iterations per chunk
+     * @param body function called with the bounds [lo, hi) of each chunk
+     */
+    template<typename F>
+    void parallelFor(int begin, int end, int grain, F &&body) {
+        if (end <= begin)
+            return;
+        grain = std::max(grain, 1);
+        int chunks = (end - begin + grain - 1) / grain;
+
+        struct State {
+            std::atomic<int> next{0};
+            std::atomic<int> done{0};
+            std::mutex m;
+            std::condition_variable cv;
+        };
+        auto state = std::make_shared<State>();
+        std::function<void(int, int)> fn = body;
+
+        auto work = [state, fn, begin, end, grain, chunks]() {
+            int c;
+            while ((c = state->next++) < chunks) {
+                int lo = begin + c * grain;
+                fn(lo, std::min(end, lo + grain));
+                if (++state->done == chunks) {
+                    std::lock_guard<std::mutex> lock(state->m);
+                    state->cv.notify_all();
+                }
+            }
+        };
+
+        int helpers = std::min<int>(chunks - 1, numWorkers.load());
+        for (int i = 0; i < helpers; i++)
+            submit(work);
+        work();
+
+        // only chunks already claimed by running threads are waited for, so nested calls cannot deadlock
+        std::unique_lock<std::mutex> lock(state->m);
+        state->cv.wait(lock, [&]() { return state->done == chunks; });
+    }
+
+    /**
+     * @brief Runs body(lo, hi) over [begin, end) split in one contiguous block per thread, block k going to worker k - 1
+     * and block 0 to the caller. With pinned workers a block always runs on the same core, so the rows of the distance
+     * matrix it first touches are placed in the memory of that core's NUMA node, and later loops split the same way
+     * read local memory. Once its own block is done, the caller takes the blocks whose worker has not started them.
+     * @param begin first iteration
+     * @param end one past the last iteration
+     * @param body function called once with the bounds [lo, hi) of each block
+     */
+    template<typename F>
+    void parallelForBlocks(int begin, int end, F &&body) {
+        if (end <= begin)
+            return;
+        int blocks = std::min<int>(getNumThreads(), end - begin);
+
+        struct State {
+            std::unique_ptr<std::atomic<bool>[]> claimed;
+            std::atomic<int> done{0};
+            std::mutex m;
+            std::condition_variable cv;
+        };
+        auto state = std::make_shared<State>();
+        state->claimed = std::make_unique<std::atomic<bool>[]>(blocks);
+        std::function<void(int, int)> fn = body;
+
+        auto work = [state, fn, begin, end, blocks](int k) {
+            if (state->claimed[k].exchange(true))
+                return;
+            fn(begin + (int) ((long long) (end - begin) * k / blocks),
+               begin + (int) ((long long) (end - begin) * (k + 1) / blocks));
+            if (++state->done == blocks) {
+                std::lock_guard<std::mutex> lock(state->m);
+                state->cv.notify_all();
+            }
+        };
+
+        for (int k = 1; k < blocks; k++)
+            submitTo(k - 1, [work, k]() { work(k); });
+        for (int k = 0; k < blocks; k++)
+            work(k);
+
+        std::unique_lock<std::mutex> lock(state->m);
+        state->cv.wait(lock, [&]() { return state->done == blocks; });
+    }
+
+    /**
+     * @brief Sorts v in parallel: every thread sorts one slice, then the slices are merged pairwise in parallel rounds
+     * @param v vector to sort
+     * @param comp strict weak ordering, the result is deterministic if it is a total order
+     * @details Time Complexity O(n log(n) / t + n log(t)) -> n: size of v, t: number of threads
+     */
+    template<typename T, typename Compare>
+    void parallelSort(std::vector<T> &v, Compare comp) {
+        int n = v.size();
+        int parts = std::min<int>(getNumThreads(), n / 4096);
+        if (parts <= 1) {
+            std::sort(v.begin(), v.end(), comp);
+            return;
+        }
+
+        std::vector<int> bounds(parts + 1);
+        for (int p = 0; p <= parts; p++)
+            bounds[p] = (long long) n * p / parts;
+
+        parallelFor(0, parts, 1, [&](int lo, int hi) {
+            for (int p = lo; p < hi; p++)
+                std::sort(v.begin() + bounds[p], v.begin() + bounds[p + 1], comp);
+        });
+
+        for (int width = 1; width < parts; width *= 2) {
+            int merges = (parts + 2 * width - 1) / (2 * width);
+            parallelFor(0, merges, 1, [&](int lo, int hi) {
+                for (int k = lo; k < hi; k++) {
+                    int a = 2 * k * width;
+                    int m = std::min(a + width, parts);
+                    int b = std::min(a + 2 * width, parts);
+                    if (m < b)
+                        std::inplace_merge(v.begin() + bounds[a], v.begin() + bounds[m], v.begin() + bounds[b], comp);
+                }
+            });
+        }
+    }
+
+private:
+    /**
+     * @brief Tasks of one worker, the owner works at the back and thieves take from the front
+     */
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void start(unsigned numThreads, bool pin);
+    void stop();
+    void workerLoop(unsigned index);
+    bool pop(unsigned index, std::function<void()> &task);
+    void push(unsigned index, std::function<void()> task);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<unsigned> numWorkers{0};
+    std::atomic<long> queued{0};
+    std::atomic<unsigned> nextQueue{0};
+    bool pinned = false;
+
+    // sleeping workers wait here for queued tasks
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+/**
+ * @brief Set of tasks run on a pool that can be waited for and cancelled together.
+ *
+ * Tasks not started when the group is cancelled are skipped; running ones can poll isCancelled to stop early. The
+ * first exception thrown by a task cancels the group and is rethrown by wait. A thread waiting for the group runs the
+ * tasks of the group no worker has started yet, and only those, so groups can be nested inside tasks without running
+ * out of threads, and a short wait never ends up running some long unrelated task.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool &pool = ThreadPool::global());
+    ~TaskGroup();
+
+    void run(std::function<void()> task);
+    void wait();
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    struct State {
+        std::atomic<int> pending{0};
+        std::atomic<bool> cancelled{false};
+        std::mutex m;
+        std::condition_variable cv;
+        // tasks not started yet, taken by the workers and by the waiting thread
+        std::deque<std::function<void()>> tasks;
+        std::exception_ptr error;
+
+        bool runOne();
+    };
+
+    void waitPending();
+
+    ThreadPool &pool;
+    std::shared_ptr<State> state;
+};
+
+#endif //PROJECT2_THREADPOOL_H
@@ -0,0 +1,85 @@
+#include "TinySolver.h"
+#include "Graph.h"
+#include "Trace.h"
+
+#include <cmath>
+
+namespace {
+    /**
+     * @brief Copies a dense n x n distance vector into the fixed-size table of TinyTsp<N> and solves it
+     */
+    template<int N>
+    double solveFixed(const std::vector<double> &dist, std::vector<int> *tour) {
+        typename TinyTsp<N>::Table table;
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                table[i][j] = dist[i * N + j];
+
+        std::array<int, N> order{};
+        double cost = TinyTsp<N>::solve(table, tour != nullptr ? &order : nullptr);
+        if (tour != nullptr && !std::isinf(cost))
+            tour->assign(order.begin(), order.end());
+        return cost;
+    }
+}
+
+/**
+ * @brief Solves a tiny instance exactly with the TinyTsp specialisation for its size
+ * @param dist row-major n x n distance table, infinity where there is no edge
+ * @param n number of vertices, from 2 to MAX_N
+ * @param tour if not null, receives the optimal tour (indices, starting at 0)
+ * @return cost of the optimal tour, INF if there is no Hamiltonian cycle
+ * @details Time Complexity O(2^n * n²)
+ */
+double TinySolver::solve(const std::vector<double> &dist, int n, std::vector<int> *tour) {
+    double cost;
+    switch (n) {
+        case 2: cost = solveFixed<2>(dist, tour); break;
+        case 3: cost = solveFixed<3>(dist, tour); break;
+        case 4: cost = solveFixed<4>(dist, tour); break;
+        case 5: cost = solveFixed<5>(dist, tour); break;
+        case 6: cost = solveFixed<6>(dist, tour); break;
+        case 7: cost = solveFixed<7>(dist, tour); break;
+        case 8: cost = solveFixed<8>(dist, tour); break;
+        case 9: cost = solveFixed<9>(dist, tour); break;
+        case 10: cost = solveFixed<10>(dist, tour); break;
+        case 11: cost = solveFixed<11>(dist, tour); break;
+        case 12: cost = solveFixed<12>(dist, tour); break;
+        case 13: cost = solveFixed<13>(dist, tour); break;
+        case 14: cost = solveFixed<14>(dist, tour); break;
+        case 15: cost = solveFixed<15>(dist, tour); break;
+        case 16: cost = solveFixed<16>(dist, tour); break;
+        default: return INF;
+    }
+    return std::isinf(cost) ? INF : cost;
+}
+
+/**
+ * @brief Solves the graph exactly, following only its edges, starting at the first vertex of the vertex set
+ * @param graph graph with 2 to MAX_N vertices
+ * @param tour if not null, receives the optimal tour (vertex infos, starting at the first vertex)
+ * @return cost of the optimal tour, INF if there is no Hamiltonian cycle
+ * @details Time Complexity O(2^v * v²) -> v: number of vertices
+ */
+double TinySolver::solve(Graph *graph, std::vector<int> *tour) {
+    TRACE_SPAN("TinySolver", "solve");
+    auto vertices = graph->getVertexSet();
+    int n = vertices.size();
+    if (n < 2 || n > MAX_N)
+        return INF;
+
+    std::vector<double> dist(n * n, std::numeric_limits<double>::infinity());
+    for (int i = 0; i < n; i++) {
+        for (Edge *e : vertices[i]->getAdj()) {
+            int j = graph->findVertexIdx(e->getDest()->getInfo());
+            dist[i * n + j] = std::min(dist[i * n + j], e->getWeight());
+        }
+    }
+
+    double cost = solve(dist, n, tour);
+    if (tour != nullptr) {
+        for (int &idx : *tour)
+            idx = vertices[idx]->getInfo();
+    }
+    return cost;
+}
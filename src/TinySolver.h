@@ -0,0 +1,137 @@
+#ifndef PROJECT2_TINYSOLVER_H
+#define PROJECT2_TINYSOLVER_H
+
+#include <array>
+#include <limits>
+#include <utility>
+#include <vector>
+
+class Graph;
+
+/**
+ * @brief Calls f(std::integral_constant<int, I>) for I = 0..N-1, fully unrolled at compile time
+ */
+template<typename F, int... I>
+inline void unrollImpl(F &&f, std::integer_sequence<int, I...>) {
+    (f(std::integral_constant<int, I>{}), ...);
+}
+
+template<int N, typename F>
+inline void unroll(F &&f) {
+    unrollImpl(f, std::make_integer_sequence<int, N>{});
+}
+
+/**
+ * @brief Exact TSP solver specialised at compile time for graphs of N vertices.
+ * Held-Karp dynamic programming over bitmask visited sets, with std::array rows and unrolled inner loops.
+ * Tours start and end at vertex 0, missing edges are infinite.
+ */
+template<int N>
+class TinyTsp {
+public:
+    static_assert(N >= 2 && N <= 16, "TinyTsp only handles 2 to 16 vertices");
+
+    using Table = std::array<std::array<double, N>, N>;
+
+    /**
+     * @brief Optimal tour cost
+     * @param dist distance table, dist[i][j] is the cost of going from i to j
+     * @param tour if not null, receives the optimal tour (vertex indices, starting at 0, without returning to it)
+     * @return cost of the optimal tour, infinity if there is no Hamiltonian cycle
+     * @details Time Complexity O(2^N * N²)
+     */
+    static double solve(const Table &dist, std::array<int, N> *tour = nullptr) {
+        constexpr double inf = std::numeric_limits<double>::infinity();
+        // masks cover vertices 1..N-1 (bit k is vertex k + 1), vertex 0 is always the start
+        constexpr int MASKS = 1 << (N - 1);
+        constexpr int FULL = MASKS - 1;
+
+        // dp[mask][j]: cheapest path leaving 0, visiting exactly mask and ending at j + 1
+        auto &dp = table();
+        for (auto &row : dp)
+            row.fill(inf);
+        unroll<N - 1>([&](auto j) {
+            dp[1 << j][j] = dist[0][j + 1];
+        });
+
+        for (int mask = 1; mask < MASKS; mask++) {
+            const auto &cur = dp[mask];
+            unroll<N - 1>([&](auto j) {
+                if (!(mask & (1 << j)) || cur[j] == inf)
+                    return;
+                const auto &row = dist[j + 1];
+                unroll<N - 1>([&](auto k) {
+                    if (mask & (1 << k))
+                        return;
+                    double cost = cur[j] + row[k + 1];
+                    double &next = dp[mask | (1 << k)][k];
+                    if (cost < next)
+                        next = cost;
+                });
+            });
+        }
+
+        double best = inf;
+        int last = -1;
+        unroll<N - 1>([&](auto j) {
+            double cost = dp[FULL][j] + dist[j + 1][0];
+            if (cost < best) {
+                best = cost;
+                last = j;
+            }
+        });
+
+        if (tour != nullptr && last >= 0)
+            rebuildTour(dist, last, *tour);
+        return best;
+    }
+
+private:
+    /**
+     * @brief Walks the dynamic programming table backwards to recover the tour ending at last + 1
+     */
+    static void rebuildTour(const Table &dist, int last, std::array<int, N> &tour) {
+        constexpr int MASKS = 1 << (N - 1);
+        const auto &dp = table();
+        int mask = MASKS - 1;
+        tour[0] = 0;
+        for (int pos = N - 1; pos >= 1; pos--) {
+            tour[pos] = last + 1;
+            int prevMask = mask & ~(1 << last);
+            int prev = -1;
+            for (int i = 0; i < N - 1 && prevMask != 0; i++) {
+                if ((prevMask & (1 << i)) && dp[prevMask][i] + dist[i + 1][last + 1] == dp[mask][last]) {
+                    prev = i;
+                    break;
+                }
+            }
+            mask = prevMask;
+            last = prev;
+        }
+    }
+
+    using Row = std::array<double, N - 1>;
+
+    /**
+     * @brief Dynamic programming table of the calling thread, reused between solves. It lives on the heap, allocated on
+     * the first solve of the thread: as a thread_local array, the tables of every N would take about 7 MB of static TLS,
+     * which glibc carves out of the stack of each thread.
+     */
+    static std::vector<Row> &table() {
+        static thread_local std::vector<Row> dp(1 << (N - 1));
+        return dp;
+    }
+};
+
+/**
+ * @brief Runtime dispatch from a vertex count to the matching TinyTsp specialisation
+ */
+class TinySolver {
+public:
+    static const int MAX_N = 16;
+
+    static double solve(const std::vector<double> &dist, int n, std::vector<int> *tour = nullptr);
+    static double solve(Graph *graph, std::vector<int> *tour = nullptr);
+};
+
+#endif //PROJECT2_TINYSOLVER_H
@@ -0,0 +1,246 @@
+#include "Tour.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Builds the tour structure that suits its size: an array for small tours, a two-level list for big ones
+ * @param order vertices 0..n-1 in tour order
+ */
+std::unique_ptr<Tour> Tour::create(const std::vector<int> &order) {
+    if ((int) order.size() < TWO_LEVEL_THRESHOLD)
+        return std::make_unique<ArrayTour>(order);
+    return std::make_unique<TwoLevelTour>(order);
+}
+
+/**
+ * @brief Vertices in tour order
+ * @param start vertex the result starts at
+ * @details Time Complexity O(n) -> n: number of vertices
+ */
+std::vector<int> Tour::toVector(int start) const {
+    std::vector<int> res;
+    if (size() == 0)
+        return res;
+    res.reserve(size());
+    int v = start;
+    do {
+        res.push_back(v);
+        v = next(v);
+    } while (v != start);
+    return res;
+}
+
+ArrayTour::ArrayTour(const std::vector<int> &order) : n(order.size()), order(order), pos(order.size()) {
+    for (int i = 0; i < n; i++)
+        pos[order[i]] = i;
+}
+
+int ArrayTour::size() const {
+    return n;
+}
+
+int ArrayTour::next(int v) const {
+    int p = pos[v] + 1;
+    return order[p == n ? 0 : p];
+}
+
+int ArrayTour::prev(int v) const {
+    int p = pos[v] - 1;
+    return order[p < 0 ? n - 1 : p];
+}
+
+/**
+ * @brief Whether b lies on the path from a forward to c, ends included
+ * @details Time Complexity O(1)
+ */
+bool ArrayTour::between(int a, int b, int c) const {
+    int pa = pos[a], pb = pos[b], pc = pos[c];
+    if (pa <= pc)
+        return pa <= pb && pb <= pc;
+    return pb >= pa || pb <= pc;
+}
+
+/**
+ * @brief 2-opt move, reversing the path b..c or the path d..a, whichever is shorter
+ * @details Time Complexity O(n) -> n: number of vertices
+ */
+void ArrayTour::flip(int a, int b, int c, int d) {
+    int inner = pos[c] - pos[b];
+    if (inner < 0)
+        inner += n;
+    if (2 * (inner + 1) <= n)
+        reverse(pos[b], pos[c]);
+    else
+        reverse(pos[d], pos[a]);
+}
+
+/**
+ * @brief Reverses the positions from..to, going forward and wrapping around the end of the array
+ */
+void ArrayTour::reverse(int from, int to) {
+    int len = to - from;
+    if (len < 0)
+        len += n;
+    for (int s = 0; s < (len + 1) / 2; s++) {
+        std::swap(order[from], order[to]);
+        pos[order[from]] = from;
+        pos[order[to]] = to;
+        from = from + 1 == n ? 0 : from + 1;
+        to = to == 0 ? n - 1 : to - 1;
+    }
+}
+
+TwoLevelTour::TwoLevelTour(const std::vector<int> &order)
+        : n(order.size()), segmentSize(std::max(8, (int) std::sqrt((double) order.size()))),
+          segmentOf(order.size()), indexOf(order.size()) {
+    build(order);
+}
+
+/**
+ * @brief Splits the order in segments of segmentSize vertices
+ * @details Time Complexity O(n) -> n: number of vertices
+ */
+void TwoLevelTour::build(const std::vector<int> &order) {
+    segments.clear();
+    ranked.clear();
+    for (int i = 0; i < n; i += segmentSize) {
+        int id = segments.size();
+        Segment s;
+        s.items.assign(order.begin() + i, order.begin() + std::min(n, i + segmentSize));
+        s.rank = id;
+        for (size_t j = 0; j < s.items.size(); j++) {
+            segmentOf[s.items[j]] = id;
+            indexOf[s.items[j]] = j;
+        }
+        segments.push_back(std::move(s));
+        ranked.push_back(id);
+    }
+}
+
+int TwoLevelTour::size() const {
+    return n;
+}
+
+/**
+ * @brief Position of v inside its segment, in tour order
+ */
+int TwoLevelTour::offset(int v) const {
+    const Segment &s = segments[segmentOf[v]];
+    return s.reversed ? (int) s.items.size() - 1 - indexOf[v] : indexOf[v];
+}
+
+/**
+ * @brief Vertex at a position of a segment, in tour order
+ */
+int TwoLevelTour::at(int s, int offset) const {
+    const Segment &seg = segments[s];
+    return seg.items[seg.reversed ? seg.items.size() - 1 - offset : offset];
+}
+
+/**
+ * @brief Position of v in the tour, comparable between any two vertices
+ */
+long long TwoLevelTour::key(int v) const {
+    return (long long) segments[segmentOf[v]].rank * (n + 1) + offset(v);
+}
+
+int TwoLevelTour::next(int v) const {
+    int s = segmentOf[v], o = offset(v) + 1;
+    if (o < (int) segments[s].items.size())
+        return at(s, o);
+    int rank = segments[s].rank + 1;
+    return at(ranked[rank == (int) ranked.size() ? 0 : rank], 0);
+}
+
+int TwoLevelTour::prev(int v) const {
+    int s = segmentOf[v], o = offset(v) - 1;
+    if (o >= 0)
+        return at(s, o);
+    int rank = segments[s].rank - 1;
+    int p = ranked[rank < 0 ? ranked.size() - 1 : rank];
+    return at(p, segments[p].items.size() - 1);
+}
+
+/**
+ * @brief Whether b lies on the path from a forward to c, ends included
+ * @details Time Complexity O(1)
+ */
+bool TwoLevelTour::between(int a, int b, int c) const {
+    long long ka = key(a), kb = key(b), kc = key(c);
+    if (ka <= kc)
+        return ka <= kb && kb <= kc;
+    return kb >= ka || kb <= kc;
+}
+
+/**
+ * @brief Splits the segment of v so that v is the first vertex of its segment, the part from v on becoming a new
+ * segment right after the old one
+ * @details Time Complexity O(sqrt(n) + s) -> n: number of vertices, s: number of segments
+ */
+void TwoLevelTour::splitBefore(int v) {
+    int id = segmentOf[v];
+    int o = offset(v);
+    if (o == 0)
+        return;
+
+    Segment &old = segments[id];
+    Segment tail;
+    tail.reversed = old.reversed;
+    int idx = indexOf[v];
+    if (!old.reversed) {
+        // tour order is the array order: the tail is items[idx..]
+        tail.items.assign(old.items.begin() + idx, old.items.end());
+        old.items.resize(idx);
+    } else {
+        // tour order is the array backwards: the tail is items[0..idx]
+        tail.items.assign(old.items.begin(), old.items.begin() + idx + 1);
+        old.items.erase(old.items.begin(), old.items.begin() + idx + 1);
+        for (size_t j = 0; j < old.items.size(); j++)
+            indexOf[old.items[j]] = j;
+    }
+
+    int tailId = segments.size();
+    for (size_t j = 0; j < tail.items.size(); j++) {
+        segmentOf[tail.items[j]] = tailId;
+        indexOf[tail.items[j]] = j;
+    }
+    int rank = old.rank + 1;
+    segments.push_back(std::move(tail));
+    ranked.insert(ranked.begin() + rank, tailId);
+    for (int r = rank; r < (int) ranked.size(); r++)
+        segments[ranked[r]].rank = r;
+}
+
+/**
+ * @brief Reverses the segments with ranks from..to (from <= to): their order and each of their orientations
+ * @details Time Complexity O(s) -> s: number of segments
+ */
+void TwoLevelTour::reverseSegments(int from, int to) {
+    std::reverse(ranked.begin() + from, ranked.begin() + to + 1);
+    for (int r = from; r <= to; r++) {
+        Segment &s = segments[ranked[r]];
+        s.reversed = !s.reversed;
+        s.rank = r;
+    }
+}
+
+/**
+ * @brief 2-opt move: after splitting before b and before d, the paths b..c and d..a are both runs of whole segments,
+ * and whichever of them does not wrap around the segment array is reversed
+ * @details Time Complexity O(sqrt(n)) amortised -> n: number of vertices
+ */
+void TwoLevelTour::flip(int a, int b, int c, int d) {
+    if ((int) ranked.size() > 2 * (n / segmentSize + 1))
+        build(toVector(a));
+
+    splitBefore(b);
+    splitBefore(d);
+    int rb = segments[segmentOf[b]].rank, rc = segments[segmentOf[c]].rank;
+    if (rb <= rc) {
+        reverseSegments(rb, rc);
+    } else {
+        int rd = segments[segmentOf[d]].rank, ra = segments[segmentOf[a]].rank;
+        reverseSegments(rd, ra);
+    }
+}
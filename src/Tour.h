@@ -0,0 +1,97 @@
+#ifndef PROJECT2_TOUR_H
+#define PROJECT2_TOUR_H
+
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Cyclic order of the vertices 0..n-1 with the queries and the move local searches need.
+ * flip(a, b, c, d), with b = next(a) and d = next(c), replaces the edges (a, b) and (c, d) by (a, c) and (b, d),
+ * which reverses the path b..c. The orientation of the cycle after a flip is up to the implementation.
+ */
+class Tour {
+public:
+    /**
+     * @brief Number of vertices from which create picks the two-level list over the array
+     */
+    static const int TWO_LEVEL_THRESHOLD = 10000;
+
+    virtual ~Tour() = default;
+
+    static std::unique_ptr<Tour> create(const std::vector<int> &order);
+
+    virtual int size() const = 0;
+    virtual int next(int v) const = 0;
+    virtual int prev(int v) const = 0;
+    virtual bool between(int a, int b, int c) const = 0;
+    virtual void flip(int a, int b, int c, int d) = 0;
+
+    std::vector<int> toVector(int start = 0) const;
+};
+
+/**
+ * @brief Tour stored as an array of vertices and the position of each vertex.
+ * Queries are O(1); a flip reverses the shorter of the two paths it could reverse, O(n) in the worst case.
+ */
+class ArrayTour : public Tour {
+public:
+    explicit ArrayTour(const std::vector<int> &order);
+
+    int size() const override;
+    int next(int v) const override;
+    int prev(int v) const override;
+    bool between(int a, int b, int c) const override;
+    void flip(int a, int b, int c, int d) override;
+
+private:
+    void reverse(int from, int to);
+
+    int n;
+    std::vector<int> order;
+    std::vector<int> pos;
+};
+
+/**
+ * @brief Two-level list: the tour is split in about sqrt(n) segments, each an array with a reversed bit, and the
+ * segments are kept in an ordered array.
+ * Queries are O(1). A flip splits at most two segments so the path to reverse is made of whole segments, then reverses
+ * the order of those segments and toggles their bits, which is O(sqrt(n)). Once splits have doubled the number of
+ * segments, the list is rebuilt in O(n), so flips stay O(sqrt(n)) amortised.
+ */
+class TwoLevelTour : public Tour {
+public:
+    explicit TwoLevelTour(const std::vector<int> &order);
+
+    int size() const override;
+    int next(int v) const override;
+    int prev(int v) const override;
+    bool between(int a, int b, int c) const override;
+    void flip(int a, int b, int c, int d) override;
+
+private:
+    /**
+     * @brief Run of consecutive vertices, read backwards when reversed is set
+     */
+    struct Segment {
+        std::vector<int> items;
+        bool reversed = false;
+        int rank = 0;
+    };
+
+    void build(const std::vector<int> &order);
+    int offset(int v) const;
+    int at(int s, int offset) const;
+    long long key(int v) const;
+    void splitBefore(int v);
+    void reverseSegments(int from, int to);
+
+    int n;
+    int segmentSize;
+    std::vector<Segment> segments;
+    // segment ids in tour order, the rank of a segment is its position here
+    std::vector<int> ranked;
+    std::vector<int> segmentOf;
+    std::vector<int> indexOf;
+};
+
+#endif //PROJECT2_TOUR_H
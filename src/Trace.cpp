@@ -0,0 +1,123 @@
+#include "Trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace {
+    /**
+     * @brief One complete ("X") event, timestamps in microseconds since the recorder started
+     */
+    struct Event {
+        const char *name;
+        const char *category;
+        long long ts;
+        long long dur;
+        int tid;
+    };
+
+    std::mutex eventsMutex;
+    std::vector<Event> events;
+    std::vector<std::pair<int, std::string>> threadNames;
+    std::string outputFile;
+    std::chrono::steady_clock::time_point origin;
+    std::atomic<int> nextThreadId{0};
+}
+
+std::atomic<bool> Trace::recording{false};
+
+/**
+ * @brief Opens a span if the recorder is running
+ * @param name name shown in the trace viewer, must outlive the recorder (string literal)
+ * @param category event category
+ */
+Trace::Span::Span(const char *name, const char *category) : name(name), category(category), start(-1) {
+    if (enabled())
+        start = now();
+}
+
+/**
+ * @brief Closes the span and stores it as a complete event
+ */
+Trace::Span::~Span() {
+    if (start < 0 || !enabled())
+        return;
+    long long end = now();
+    int tid = threadId();
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    events.push_back({name, category, start, end - start, tid});
+}
+
+/**
+ * @brief Starts recording. Events are kept in memory until stop() writes them.
+ * @param filename path of the JSON file to write
+ */
+void Trace::start(const std::string &filename) {
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    events.clear();
+    outputFile = filename;
+    origin = std::chrono::steady_clock::now();
+    recording = true;
+}
+
+/**
+ * @brief Stops recording and writes every event to the file given to start()
+ * @return true if the file was written
+ * @details Time Complexity O(e) -> e: number of recorded events
+ */
+bool Trace::stop() {
+    if (!recording.exchange(false))
+        return false;
+
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    std::ofstream ofs(outputFile);
+    if (!ofs.is_open())
+        return false;
+
+    ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    ofs << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Project2\"}}";
+    for (auto &t : threadNames) {
+        ofs << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t.first
+            << ",\"args\":{\"name\":\"" << t.second << "\"}}";
+    }
+    for (auto &e : events) {
+        ofs << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\",\"ts\":" << e.ts
+            << ",\"dur\":" << e.dur << ",\"pid\":1,\"tid\":" << e.tid << "}";
+    }
+    ofs << "\n]}\n";
+    events.clear();
+    return true;
+}
+
+/**
+ * @brief Whether the recorder is running
+ */
+bool Trace::enabled() {
+    return recording.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Names the calling thread in the trace viewer
+ * @param name thread name
+ */
+void Trace::setThreadName(const std::string &name) {
+    int tid = threadId();
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    threadNames.emplace_back(tid, name);
+}
+
+/**
+ * @brief Microseconds since the recorder started
+ */
+long long Trace::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+/**
+ * @brief Small sequential id of the calling thread, 0 for the first thread that records
+ */
+int Trace::threadId() {
+    thread_local int id = nextThreadId++;
+    return id;
+}
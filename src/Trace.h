@@ -0,0 +1,42 @@
+#ifndef PROJECT2_TRACE_H
+#define PROJECT2_TRACE_H
+
+#include <atomic>
+#include <string>
+
+/**
+ * @brief Optional timeline recorder that writes Chrome trace-event JSON (viewable in chrome://tracing or Perfetto).
+ * Recording is off until start() is called, in which case a span costs a single flag check.
+ */
+class Trace {
+public:
+    /**
+     * @brief Records a complete event spanning its own lifetime. Spans opened inside it show up nested.
+     */
+    class Span {
+    public:
+        explicit Span(const char *name, const char *category = "tsp");
+        ~Span();
+    private:
+        const char *name;
+        const char *category;
+        long long start;
+    };
+
+    static void start(const std::string &filename);
+    static bool stop();
+    static bool enabled();
+    static void setThreadName(const std::string &name);
+
+private:
+    static long long now();
+    static int threadId();
+
+    static std::atomic<bool> recording;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(...) Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(__VA_ARGS__)
+
+#endif //PROJECT2_TRACE_H
@@ -1,6 +1,8 @@
 #include "Vertex.h"
 #include "Edge.h"
 
+#include <algorithm>
+
 
 /**
  * @brief Vertex Constructor
@@ -58,13 +60,26 @@ void Vertex::removeOutgoingEdges() {
     }
 }
 
+/**
+ * @brief Drops the edges marked as removed from the outgoing and incoming lists, without deleting them
+ * @details Time Complexity = O(n) n-> number of incoming and adjacent edges
+ */
+void Vertex::dropRemovedEdges() {
+    auto removed = [](Edge *e) { return e->isRemoved(); };
+    adj.erase(std::remove_if(adj.begin(), adj.end(), removed), adj.end());
+    incoming.erase(std::remove_if(incoming.begin(), incoming.end(), removed), incoming.end());
+}
+
 
 int Vertex::getInfo() const {
     return this->info;
 }
 
 
-std::vector<Edge*> Vertex::getAdj() const {
+/**
+ * @brief Outgoing edges, as a view into the vertex (no copy). Invalidated when edges are added or removed.
+ */
+std::span<Edge *const> Vertex::getAdj() const {
     return this->adj;
 }
 
@@ -85,7 +100,10 @@ Edge *Vertex::getPath() const {
     return this->path;
 }
 
-std::vector<Edge *> Vertex::getIncoming() const {
+/**
+ * @brief Incoming edges, as a view into the vertex (no copy). Invalidated when edges are added or removed.
+ */
+std::span<Edge *const> Vertex::getIncoming() const {
     return this->incoming;
 }
 
@@ -161,6 +179,17 @@ void Vertex::addChild(Vertex *child) {
     this->children.push_back(child);
 }
 
-std::vector<Vertex *> Vertex::getChildren() const {
+/**
+ * @brief Children in the last spanning tree, as a view into the vertex (no copy)
+ */
+std::span<Vertex *const> Vertex::getChildren() const {
     return children;
 }
+
+/**
+ * @brief Bytes held by the vertex, including the capacity of its adjacency, incoming and children lists
+ * @return size in bytes
+ */
+size_t Vertex::getMemoryUsage() const {
+    return sizeof(Vertex) + (adj.capacity() + incoming.capacity()) * sizeof(Edge *) + children.capacity() * sizeof(Vertex *);
+}
@@ -2,6 +2,8 @@
 #define PROJECT2_VERTEX_H
 
 #include "Edge.h"
+#include <cstddef>
+#include <span>
 #include <vector>
 #include <queue>
 
@@ -13,17 +15,17 @@ public:
     Vertex(int in, double lon, double lat);
 
     int getInfo() const;
-    std::vector<Edge *> getAdj() const;
+    std::span<Edge *const> getAdj() const;
     bool isVisited() const;
     bool isProcessing() const;
     unsigned int getIndegree() const;
     double getDist() const;
     Vertex *getParent() const;
-    std::vector<Vertex *> getChildren() const;
+    std::span<Vertex *const> getChildren() const;
     double getLat() const;
     double getLon() const;
     Edge *getPath() const;
-    std::vector<Edge *> getIncoming() const;
+    std::span<Edge *const> getIncoming() const;
 
     void setInfo(int info);
     void setVisited(bool visited);
@@ -37,6 +39,8 @@ public:
     Edge * addEdge(Vertex *dest, double w);
     bool removeEdge(int in);
     void removeOutgoingEdges();
+    void dropRemovedEdges();
+    size_t getMemoryUsage() const;
 
     struct greaterDist {
         bool operator() (const std::pair<Vertex *, double> l, const std::pair<Vertex *, double> r) const {
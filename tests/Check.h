@@ -0,0 +1,44 @@
+#ifndef PROJECT2_CHECK_H
+#define PROJECT2_CHECK_H
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+#include "../src/Graph.h"
+#include "../src/Auxiliar.h"
+
+/**
+ * @brief Stops the check with a message if a condition does not hold
+ * @param condition condition that must hold
+ * @param what what the condition means, printed when it fails
+ */
+inline void check(bool condition, const char *what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << "\n";
+        std::exit(1);
+    }
+}
+
+/**
+ * @brief Complete graph of n vertices 0..n-1 with random integer weights, like the medium datasets
+ * @param g empty graph
+ * @param n number of vertices
+ * @param seed seed of the weights, so the check is reproducible
+ */
+inline void completeGraph(Graph *g, int n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> weight(1, 1000);
+    g->setMatrix(Auxiliar::initMatrix(n), n);
+    for (int v = 0; v < n; v++)
+        g->addVertex(v);
+    for (int v = 0; v < n; v++) {
+        for (int u = v + 1; u < n; u++) {
+            double w = weight(rng);
+            g->addBidirectionalEdge(v, u, w);
+            g->addToDistMatrix(v, u, w);
+        }
+    }
+}
+
+#endif //PROJECT2_CHECK_H
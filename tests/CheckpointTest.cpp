@@ -0,0 +1,35 @@
+#include "Check.h"
+#include "../src/ExactSearch.h"
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+
+/**
+ * @brief A branch and bound stopped early and resumed from its checkpoint finds the same optimum as one run in a go
+ */
+int main() {
+    Graph g;
+    completeGraph(&g, 14, 7);
+    std::string file = (std::filesystem::temp_directory_path() / "project2-checkpoint-test").string();
+
+    ExactSearch whole(&g, 0);
+    double optimum = whole.run();
+    check(whole.isComplete(), "the uninterrupted search finishes");
+
+    // a stop flag set from the start makes the search save its frontier and return at its first check
+    std::atomic<bool> stop{true};
+    ExactSearch stopped(&g, 0);
+    stopped.share(nullptr, &stop);
+    stopped.setCheckpoint(file, 60000);
+    stopped.run();
+    check(!stopped.isComplete(), "the stopped search does not finish");
+
+    ExactSearch resumed(&g, 0);
+    resumed.setCheckpoint(file, 60000);
+    double cost = resumed.run();
+    check(resumed.wasResumed(), "the second search resumes from the checkpoint");
+    check(resumed.isComplete(), "the resumed search finishes");
+    check(cost == optimum, "the resumed search finds the same optimum");
+    return 0;
+}
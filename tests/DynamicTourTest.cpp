@@ -0,0 +1,66 @@
+#include "Check.h"
+#include "../src/DynamicTour.h"
+#include "../src/Management.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Checks that a tour visits every vertex of the graph once and that its kept cost is the cost of its vertices
+ */
+static void checkTour(Graph *g, const DynamicTour &tour) {
+    std::vector<int> visited = tour.getTour(), infos;
+    for (Vertex *v : g->getVertexSet())
+        infos.push_back(v->getInfo());
+    std::sort(visited.begin(), visited.end());
+    std::sort(infos.begin(), infos.end());
+    check(visited == infos, "the tour is a permutation of the vertices of the graph");
+    check(std::fabs(tour.getCost() - Management::tourCost(g, tour.getTour())) < 1e-6,
+          "the kept cost is the cost of the tour");
+}
+
+/**
+ * @brief Removing stops from a repaired tour, compacting the graph under it and joining a new stop, the way a batch
+ * request of the server does, leaves a valid tour at every step
+ */
+int main() {
+    const int n = 60;
+    Graph g;
+    completeGraph(&g, n, 23);
+    std::vector<int> order(n);
+    for (int v = 0; v < n; v++)
+        order[v] = v;
+    DynamicTour tour(&g, order);
+    checkTour(&g, tour);
+
+    // a few removals, not enough to compact
+    tour.removeAll({5, 17, 42});
+    GraphBatch few;
+    for (int v : {5, 17, 42})
+        few.removeVertex(v);
+    check(g.apply(few).renumbered.empty(), "three removals do not compact the graph");
+    checkTour(&g, tour);
+
+    // most of the rest, which compacts the graph and renumbers the infos the tour holds
+    GraphBatch most;
+    std::vector<int> gone;
+    for (int v = 0; v < n; v++) {
+        if (v % 4 != 0 && v != 5 && v != 17 && v != 42) {
+            most.removeVertex(v);
+            gone.push_back(g.getInternalId(v));
+        }
+    }
+    // a new stop joined to the graph by its edges, as the graphs without coordinates need
+    most.addVertex(n);
+    for (int v : {0, 4, 8})
+        most.addEdge(n, v, 10 + v);
+    tour.removeAll(gone);
+    BatchResult result = g.apply(most);
+    check(!result.renumbered.empty(), "removing most of the vertices compacts the graph");
+    tour.renumber(result.renumbered);
+    for (int in : result.added)
+        tour.insert(in);
+    checkTour(&g, tour);
+    check(tour.contains(g.getInternalId(n)), "the new stop is on the tour");
+    return 0;
+}
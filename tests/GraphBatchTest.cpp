@@ -0,0 +1,43 @@
+#include "Check.h"
+
+#include <map>
+#include <utility>
+
+/**
+ * @brief Removing most of a graph in one batch compacts it, and the vertices left keep their ids and the distances
+ * between them, including those of a cut edge on a graph without coordinates
+ */
+int main() {
+    const int n = 60;
+    Graph g;
+    completeGraph(&g, n, 11);
+
+    std::vector<int> kept;
+    GraphBatch batch;
+    for (int v = 0; v < n; v++) {
+        if (v % 3 == 0)
+            kept.push_back(v);
+        else
+            batch.removeVertex(v);
+    }
+    batch.removeEdge(0, 3);
+    std::map<std::pair<int, int>, double> before;
+    for (int a : kept) {
+        for (int b : kept)
+            before[{a, b}] = g.getDist(g.getInternalId(a), g.getInternalId(b));
+    }
+
+    BatchResult result = g.apply(batch);
+    check(result.removed.size() == (size_t) (n - kept.size()), "every removed vertex is reported");
+    check(!result.renumbered.empty(), "removing two thirds of the vertices compacts the graph");
+    check(g.getNumVertex() == (int) kept.size(), "only the kept vertices are left");
+
+    for (int a : kept) {
+        int in = g.getInternalId(a);
+        check(in >= 0 && in < (int) kept.size(), "the kept vertices are renumbered 0..v-1");
+        check(g.findVertex(in) != nullptr && g.getOriginalId(in) == a, "a kept vertex keeps its dataset id");
+        for (int b : kept)
+            check(g.getDist(in, g.getInternalId(b)) == before[{a, b}], "the distances between kept vertices stay");
+    }
+    return 0;
+}